@@ -0,0 +1,9 @@
+"""
+Performance benchmarks of string_grouper.  Run each module with `python -m benchmarks.<module>`:
+
+    names       synthetic company names with near duplicates
+    stages      times and memory-profiles each stage of StringGrouper.fit and get_groups (JSON output)
+    compare     compares two JSON outputs of stages, stage by stage
+    engines     compares the engines computing the cosine similarities (time and recall)
+    symmetrize  compares the csr and the former pandas symmetrization of self-join matches
+"""
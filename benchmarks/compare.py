@@ -0,0 +1,53 @@
+"""
+Compares two JSON result files of benchmarks.stages stage by stage, and exits with status 1 if any stage of the
+candidate took more wall time (or traced more peak memory) than the baseline by more than a given factor.
+Stages which took less than --min-seconds in the baseline are not judged by their time, as they are too noisy.
+
+Usage:  python -m benchmarks.compare baseline.json candidate.json [--threshold 1.2] [--min-seconds 0.05]
+"""
+import argparse
+import json
+import sys
+from typing import Dict, Tuple
+
+MEASURES = (('wall_s', 'wall time'), ('peak_traced_mb', 'peak memory'))
+
+
+def load_stages(path: str) -> Dict[Tuple[str, int, str], Dict[str, float]]:
+    """Returns the records of a result file by (mode, number of strings, stage)"""
+    with open(path) as file:
+        report = json.load(file)
+    return {(result['mode'], result['n'], stage): record
+            for result in report['results'] for stage, record in result['stages'].items()}
+
+
+def main(args=None) -> int:
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('baseline')
+    parser.add_argument('candidate')
+    parser.add_argument('--threshold', type=float, default=1.2)
+    parser.add_argument('--min-seconds', type=float, default=0.05)
+    args = parser.parse_args(args)
+    baseline, candidate = load_stages(args.baseline), load_stages(args.candidate)
+
+    regressions = 0
+    print(f"{'mode':>6} {'strings':>10} {'stage':>18} {'measure':>12} {'baseline':>10} {'candidate':>10} {'ratio':>7}")
+    for key in sorted(baseline.keys() & candidate.keys()):
+        for measure, label in MEASURES:
+            old, new = baseline[key].get(measure), candidate[key].get(measure)
+            if old is None or new is None:
+                continue
+            ratio = new / old if old > 0 else float('inf') if new > 0 else 1.
+            is_judged = measure != 'wall_s' or old >= args.min_seconds
+            is_regression = is_judged and ratio > args.threshold
+            regressions += is_regression
+            mode, n, stage = key
+            print(f"{mode:>6} {n:>10} {stage:>18} {label:>12} {old:>10.3f} {new:>10.3f} {ratio:>6.2f}x"
+                  f"{'  <-- regression' if is_regression else ''}")
+    for key in sorted(baseline.keys() ^ candidate.keys()):
+        print(f"{' '.join(map(str, key))}: only in {'baseline' if key in baseline else 'candidate'}")
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,113 @@
+"""
+Compares the engines of StringGrouper (the algorithms computing the top-n cosine similarities, that is,
+StringGrouper._build_matches) on the tutorial data (tutorials/accounts.csv) and on synthetic company names (see
+benchmarks.names): the best wall time of each engine, and the fraction of the matches of sparse_dot_topn (the
+reference) that it finds.  The results are printed and, optionally, written as JSON.
+
+Usage:  python -m benchmarks.engines [--sizes 10000 100000 ...] [--engines sparse_dot_topn blocked ...]
+                                     [--modes group match] [--repeats 3] [--output results.json]
+                                     [--option name=value ...]
+"""
+import argparse
+import json
+import os
+import platform
+import time
+from typing import Dict, Any, Tuple
+import numpy as np
+import pandas as pd
+from scipy.sparse.csr import csr_matrix
+from string_grouper.string_grouper import StringGrouper, ENGINE_SPARSE_DOT_TOPN, ENGINE_SYMMETRIC, ENGINE_PRUNED, \
+    ENGINE_LSH, ENGINE_BLOCKED
+from benchmarks.names import company_names
+from benchmarks.stages import git_commit, parse_option
+
+ACCOUNTS_CSV = os.path.join(os.path.dirname(__file__), '..', 'tutorials', 'accounts.csv')
+DEFAULT_SIZES = [10_000, 100_000, 1_000_000, 10_000_000]
+ENGINES = (ENGINE_SPARSE_DOT_TOPN, ENGINE_BLOCKED, ENGINE_SYMMETRIC, ENGINE_PRUNED, ENGINE_LSH)
+MODES = ('group', 'match')
+DEFAULT_OPTIONS = {}    # (so the engines run on the default number_of_processes unless --option sets it)
+
+
+def matrices(mode: str, strings: pd.Series, options: Dict[str, Any]) -> Tuple[csr_matrix, csr_matrix]:
+    """Returns the TF-IDF matrices which the engines multiply"""
+    if mode == 'group':
+        string_grouper = StringGrouper(strings, **options)
+    else:
+        half = len(strings) // 2
+        string_grouper = StringGrouper(strings.iloc[:half], strings.iloc[half:].reset_index(drop=True), **options)
+    return string_grouper._get_tf_idf_matrices()
+
+
+def time_engine(engine: str,
+                mode: str,
+                strings: pd.Series,
+                master_matrix: csr_matrix,
+                duplicate_matrix: csr_matrix,
+                options: Dict[str, Any],
+                repeats: int) -> Tuple[float, csr_matrix]:
+    """Returns the best wall time of the engine's _build_matches over repeats runs, and its matches"""
+    # (only the options of this StringGrouper matter, and whether it has duplicates)
+    duplicates = None if mode == 'group' else strings.iloc[:duplicate_matrix.shape[0]]
+    string_grouper = StringGrouper(strings.iloc[:master_matrix.shape[0]], duplicates, engine=engine, **options)
+    best = float('inf')
+    for _ in range(repeats):
+        start = time.perf_counter()
+        matches = string_grouper._build_matches(master_matrix, duplicate_matrix)
+        best = min(best, time.perf_counter() - start)
+    return best, matches
+
+
+def recall(matches: csr_matrix, reference: csr_matrix) -> float:
+    """Returns the fraction of the (nonzero) matches of reference that are also in matches"""
+    reference = (reference != 0).astype(np.int8)
+    if reference.nnz == 0:
+        return 1.0
+    return reference.multiply(matches != 0).nnz / reference.nnz
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--sizes', type=int, nargs='+', default=DEFAULT_SIZES)
+    parser.add_argument('--engines', nargs='+', choices=ENGINES, default=list(ENGINES))
+    parser.add_argument('--modes', nargs='+', choices=MODES, default=list(MODES))
+    parser.add_argument('--repeats', type=int, default=3)
+    parser.add_argument('--output', help='JSON file to write the results to')
+    parser.add_argument('--option', action='append', default=[], type=parse_option,
+                        help='StringGrouper option as name=value (may be repeated)')
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args(args)
+    options = dict(DEFAULT_OPTIONS, **dict(args.option))
+    engines = [ENGINE_SPARSE_DOT_TOPN] + [engine for engine in args.engines if engine != ENGINE_SPARSE_DOT_TOPN]
+
+    datasets = [('accounts', pd.read_csv(ACCOUNTS_CSV)['name'])]
+    datasets += [('synthetic', company_names(n, seed=args.seed)) for n in args.sizes]
+    report = {'commit': git_commit(),
+              'python': platform.python_version(),
+              'platform': platform.platform(),
+              'options': options,
+              'results': []}
+    print(f"{'data':>10} {'mode':>6} {'strings':>10} {'engine':>16} {'wall (s)':>10} {'speed-up':>9} {'recall':>7}")
+    for name, strings in datasets:
+        for mode in args.modes:
+            master_matrix, duplicate_matrix = matrices(mode, strings, options)
+            reference_time, reference = None, None
+            for engine in engines:
+                wall, matches = time_engine(engine, mode, strings, master_matrix, duplicate_matrix, options,
+                                            args.repeats)
+                if reference is None:
+                    reference_time, reference = wall, matches
+                record = {'data': name, 'mode': mode, 'n': len(strings), 'engine': engine, 'wall_s': wall,
+                          'speed_up': reference_time / wall if wall > 0 else None,
+                          'recall': recall(matches, reference)}
+                report['results'].append(record)
+                speed_up = '' if record['speed_up'] is None else f"{record['speed_up']:.2f}"
+                print(f"{name:>10} {mode:>6} {len(strings):>10} {engine:>16} {wall:>10.3f} {speed_up:>9} "
+                      f"{record['recall']:>7.4f}")
+    if args.output:
+        with open(args.output, 'w') as file:
+            json.dump(report, file, indent=2)
+
+
+if __name__ == '__main__':
+    main()
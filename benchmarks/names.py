@@ -0,0 +1,98 @@
+"""
+Synthetic company names for the benchmarks.  Random base names (a few words and a legal suffix such as 'LLC' or
+'INC') are mixed with noisy variants of them: typos, changed legal suffixes, abbreviations and changes of case, so
+that a realistic share of the strings have near duplicates.
+
+Usage:  python -m benchmarks.names [number_of_strings]
+"""
+import sys
+import random
+from typing import List
+import pandas as pd
+
+WORDS = [
+    'Acme', 'Advanced', 'Alpha', 'American', 'Apex', 'Atlantic', 'Bay', 'Blue', 'Bright', 'Capital', 'Central',
+    'Century', 'Coastal', 'Consolidated', 'Continental', 'Creative', 'Delta', 'Diamond', 'Digital', 'Dynamic',
+    'Eagle', 'East', 'Eastern', 'Empire', 'Energy', 'Engineering', 'Enterprise', 'Federal', 'First', 'Food',
+    'Future', 'General', 'Global', 'Golden', 'Green', 'Harbor', 'Health', 'Heritage', 'Highland', 'Horizon',
+    'Imperial', 'Industrial', 'Integrated', 'International', 'Island', 'Keystone', 'Lake', 'Liberty', 'Lincoln',
+    'Logistics', 'Management', 'Manufacturing', 'Maple', 'Media', 'Medical', 'Metro', 'Mid', 'Millennium',
+    'Mountain', 'National', 'New', 'North', 'Northern', 'Oak', 'Ocean', 'Pacific', 'Paramount', 'Park', 'Peak',
+    'Pine', 'Pioneer', 'Premier', 'Prime', 'Quality', 'Red', 'Regional', 'River', 'Rock', 'Royal', 'Security',
+    'Services', 'Silver', 'Sky', 'Smart', 'Solutions', 'South', 'Southern', 'Standard', 'Star', 'State', 'Summit',
+    'Sun', 'Superior', 'Systems', 'Technologies', 'Trans', 'Tri', 'Union', 'United', 'Universal', 'Valley',
+    'Vision', 'West', 'Western', 'White', 'World', 'Associates', 'Brothers', 'Development', 'Industries'
+]
+SUFFIXES = [
+    'LLC', 'L.L.C.', 'INC', 'Inc.', 'Incorporated', 'Corp', 'Corp.', 'Corporation', 'Co.', 'Company', 'Ltd',
+    'Limited', 'LLP', 'LP', 'PLC', 'GmbH', 'S.A.', 'Holdings', 'Group', 'Partners'
+]
+ABBREVIATIONS = {
+    'International': 'Intl', 'Corporation': 'Corp', 'Company': 'Co', 'Incorporated': 'Inc', 'Limited': 'Ltd',
+    'Manufacturing': 'Mfg', 'Technologies': 'Tech', 'Services': 'Svcs', 'Associates': 'Assoc', 'Brothers': 'Bros',
+    'National': 'Natl', 'Systems': 'Sys', 'Industries': 'Inds', 'Management': 'Mgmt', 'Development': 'Dev',
+    'Engineering': 'Eng', 'Solutions': 'Sol', 'Logistics': 'Log', 'Medical': 'Med', 'and': '&'
+}
+LETTERS = 'abcdefghijklmnopqrstuvwxyz'
+
+
+def base_name(rng: random.Random) -> str:
+    """Returns a random company name of one to three words (sometimes joined by 'and') and a legal suffix"""
+    words = rng.sample(WORDS, rng.randint(1, 3))
+    if len(words) > 1 and rng.random() < 0.1:
+        words.insert(-1, 'and')
+    return ' '.join(words + [rng.choice(SUFFIXES)])
+
+
+def typo(name: str, rng: random.Random) -> str:
+    """Deletes, inserts, substitutes or transposes one character of name"""
+    i = rng.randrange(len(name))
+    kind = rng.randrange(4)
+    if kind == 0:
+        return name[:i] + name[i + 1:]
+    if kind == 1:
+        return name[:i] + rng.choice(LETTERS) + name[i:]
+    if kind == 2:
+        return name[:i] + rng.choice(LETTERS) + name[i + 1:]
+    return name[:i] + name[i + 1:i + 2] + name[i:i + 1] + name[i + 2:]
+
+
+def change_suffix(name: str, rng: random.Random) -> str:
+    """Replaces the legal suffix (the last word) of name by another one"""
+    return f'{name.rsplit(" ", 1)[0]} {rng.choice(SUFFIXES)}'
+
+
+def abbreviate(name: str, rng: random.Random) -> str:
+    """Abbreviates the words of name that have a common abbreviation"""
+    return ' '.join(ABBREVIATIONS.get(word, word) for word in name.split(' '))
+
+
+def change_case(name: str, rng: random.Random) -> str:
+    return name.upper() if rng.random() < 0.5 else name.lower()
+
+
+NOISES = [typo, typo, change_suffix, abbreviate, change_case]
+
+
+def variant(name: str, rng: random.Random) -> str:
+    """Returns a noisy variant of name (one or two of typos, changed suffix, abbreviations or changed case)"""
+    for noise in rng.sample(NOISES, rng.randint(1, 2)):
+        name = noise(name, rng)
+    return name
+
+
+def company_names(n: int, duplicate_fraction: float = 0.5, seed: int = 0) -> pd.Series:
+    """
+    Returns a Series of n synthetic company names in random order, of which a duplicate_fraction are noisy variants
+    of the others.  The same n, duplicate_fraction and seed always give the same names.
+    """
+    rng = random.Random(seed)
+    n_variants = int(n * duplicate_fraction)
+    names: List[str] = [base_name(rng) for _ in range(n - n_variants)]
+    names += [variant(rng.choice(names), rng) for _ in range(n_variants)] if names else []
+    rng.shuffle(names)
+    return pd.Series(names, name='company_name')
+
+
+if __name__ == '__main__':
+    print(company_names(int(sys.argv[1]) if len(sys.argv) > 1 else 20).to_string())
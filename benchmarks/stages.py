@@ -0,0 +1,111 @@
+"""
+Times and memory-profiles each stage of StringGrouper.fit and StringGrouper.get_groups on synthetic company names
+(see benchmarks.names), either grouping all names ('group', as group_similar_strings does) or matching one half of
+them with the other ('match', as match_most_similar does).  The results are printed and, optionally, written as JSON
+which benchmarks.compare compares between commits.
+
+The stages and their measurements are those StringGrouper records itself with collect_stats=True (see
+StringGrouper.stats), so they follow fit and get_groups as they are.  Each stage is timed (wall and CPU time) in a
+first run; if memory is profiled, the peak memory traced by tracemalloc during each stage is measured in a second
+run, since tracing slows down allocations.  peak_rss_delta_mb is the increase of the peak resident set size of the
+whole process during each stage.
+
+Usage:  python -m benchmarks.stages [--sizes 10000 100000 ...] [--modes group match] [--output results.json]
+                                    [--no-memory] [--option name=value ...]
+"""
+import argparse
+import json
+import platform
+import subprocess
+import tracemalloc
+from typing import Dict, List, Optional, Tuple, Any
+import pandas as pd
+from string_grouper.string_grouper import StringGrouper
+from benchmarks.names import company_names
+
+DEFAULT_SIZES = [10_000, 100_000, 1_000_000, 10_000_000]
+MODES = ('group', 'match')
+DEFAULT_OPTIONS = {'number_of_processes': 1}
+
+
+def run_stages(mode: str, strings: pd.Series, options: Dict[str, Any]) -> List[dict]:
+    """
+    Runs fit and get_groups as group_similar_strings ('group') or match_most_similar ('match') do, and returns the
+    records of their stages (StringGrouper.stats)
+    """
+    options = dict(options, collect_stats=True)
+    if mode == 'group':
+        string_grouper = StringGrouper(strings, **options).fit()
+    else:
+        half = len(strings) // 2
+        string_grouper = StringGrouper(strings.iloc[:half], strings.iloc[half:].reset_index(drop=True),
+                                       **options).fit(nearest_only=True)
+    string_grouper.get_groups()
+    return string_grouper.stats
+
+
+def profile(mode: str, strings: pd.Series, options: Dict[str, Any], trace_memory: bool = True) -> Dict[str, Dict]:
+    """Returns the wall and CPU time, and peak memory of each stage of fit and get_groups (by stage name)"""
+    results = {record['stage']: record for record in run_stages(mode, strings, options)}
+    if trace_memory:
+        tracemalloc.start()
+        try:
+            records = run_stages(mode, strings, options)
+        finally:
+            tracemalloc.stop()
+        for record in records:
+            results[record['stage']]['peak_traced_mb'] = record.get('peak_traced_mb')
+    return results
+
+
+def git_commit() -> Optional[str]:
+    try:
+        return subprocess.run(['git', 'rev-parse', 'HEAD'], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                              universal_newlines=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def parse_option(option: str) -> Tuple[str, Any]:
+    """Parses name=value, where value is JSON (e.g. 0.8, true, null or "float32") or else a plain string"""
+    name, value = option.split('=', 1)
+    try:
+        return name, json.loads(value)
+    except ValueError:
+        return name, value
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--sizes', type=int, nargs='+', default=DEFAULT_SIZES)
+    parser.add_argument('--modes', nargs='+', choices=MODES, default=list(MODES))
+    parser.add_argument('--output', help='JSON file to write the results to')
+    parser.add_argument('--no-memory', action='store_true', help='do not trace the memory of each stage')
+    parser.add_argument('--option', action='append', default=[], type=parse_option,
+                        help='StringGrouper option as name=value (may be repeated)')
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args(args)
+    options = dict(DEFAULT_OPTIONS, **dict(args.option))
+
+    report = {'commit': git_commit(),
+              'python': platform.python_version(),
+              'platform': platform.platform(),
+              'options': options,
+              'results': []}
+    print(f"{'mode':>6} {'strings':>10} {'stage':>22} {'wall (s)':>10} {'cpu (s)':>10} {'peak (MiB)':>11}")
+    for n in args.sizes:
+        strings = company_names(n, seed=args.seed)
+        for mode in args.modes:
+            stages = profile(mode, strings, options, trace_memory=not args.no_memory)
+            report['results'].append({'mode': mode, 'n': n, 'stages': stages})
+            for name, record in stages.items():
+                peak = record.get('peak_traced_mb')
+                print(f"{mode:>6} {n:>10} {name:>22} {record['wall_s']:>10.3f} {record['cpu_s']:>10.3f} "
+                      f"{'' if peak is None else f'{peak:.1f}':>11}")
+    if args.output:
+        with open(args.output, 'w') as file:
+            json.dump(report, file, indent=2)
+
+
+if __name__ == '__main__':
+    main()
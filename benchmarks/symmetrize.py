@@ -0,0 +1,69 @@
+"""
+Benchmarks the sparse (csr) symmetrization of the matches of a self-join (StringGrouper._symmetrize_matches followed by
+StringGrouper._get_matches_list) against the former pandas implementation, which combined two MultiIndexed copies of
+the list of matches with DataFrame.combine_first.
+
+Usage:  python -m benchmarks.symmetrize [number_of_strings ...]
+"""
+import sys
+import time
+import numpy as np
+import pandas as pd
+from scipy.sparse.csr import csr_matrix
+from string_grouper.string_grouper import StringGrouper, DEFAULT_MAX_N_MATCHES, DEFAULT_MIN_SIMILARITY
+
+DEFAULT_SIZES = [10_000, 100_000, 1_000_000]
+N_REPEATS = 3
+
+
+def random_matches(n: int, n_matches_per_row: int = DEFAULT_MAX_N_MATCHES, seed: int = 0) -> csr_matrix:
+    """Returns a random n x n matrix of similarities shaped like the output of awesome_cossim_topn"""
+    rng = np.random.RandomState(seed)
+    rows = np.repeat(np.arange(n), n_matches_per_row)
+    cols = rng.randint(0, n, size=len(rows))
+    matches = csr_matrix((np.ones(len(rows)), (rows, cols)), shape=(n, n))
+    matches.data = rng.uniform(DEFAULT_MIN_SIMILARITY, 1., size=matches.nnz)
+    return matches
+
+
+def combine_first_symmetrize(matches: csr_matrix) -> pd.DataFrame:
+    """The former implementation: [matches_list] UNION [transposed matches_list] via MultiIndexes"""
+    matches_list = StringGrouper._get_matches_list(matches)
+    return matches_list.set_index(['master_side', 'dupe_side'])\
+        .combine_first(
+            matches_list.rename(
+                columns={
+                    'master_side': 'dupe_side',
+                    'dupe_side': 'master_side'
+                }
+            ).set_index(['master_side', 'dupe_side'])
+        ).reset_index()
+
+
+def csr_symmetrize(matches: csr_matrix) -> pd.DataFrame:
+    """The current implementation: element-wise maximum of the matches and their transpose"""
+    return StringGrouper._get_matches_list(StringGrouper._symmetrize_matches(matches))
+
+
+def best_time(function, *args) -> float:
+    best = float('inf')
+    for _ in range(N_REPEATS):
+        start = time.perf_counter()
+        function(*args)
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main(sizes):
+    print(f"{'strings':>12} {'combine_first (s)':>18} {'csr maximum (s)':>16} {'speed-up':>9}")
+    for n in sizes:
+        matches = random_matches(n)
+        # both implementations must find the same pairs of matches:
+        pairs = ['master_side', 'dupe_side']
+        pd.testing.assert_frame_equal(combine_first_symmetrize(matches)[pairs], csr_symmetrize(matches)[pairs])
+        old, new = best_time(combine_first_symmetrize, matches), best_time(csr_symmetrize, matches)
+        print(f'{n:>12} {old:>18.3f} {new:>16.3f} {old / new:>8.1f}x')
+
+
+if __name__ == '__main__':
+    main([int(arg) for arg in sys.argv[1:]] or DEFAULT_SIZES)
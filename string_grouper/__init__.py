@@ -1,2 +1,2 @@
 from .string_grouper import compute_pairwise_similarities, group_similar_strings, match_most_similar, match_strings, \
-StringGrouperConfig, StringGrouper
+StringGrouperConfig, StringGrouper, lsh_recall
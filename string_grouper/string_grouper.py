@@ -1,17 +1,49 @@
 import pandas as pd
 import numpy as np
 import re
+import os
+import sys
+import shutil
+import tempfile
+import weakref
+import itertools
+import time
+import tracemalloc
+import json
 import multiprocessing
-from sklearn.feature_extraction.text import TfidfVectorizer
+from sklearn.feature_extraction.text import CountVectorizer
+from sklearn.preprocessing import normalize
 from scipy.sparse.csr import csr_matrix
+from scipy.sparse import vstack, diags
 from scipy.sparse.csgraph import connected_components
-from typing import Tuple, NamedTuple, List, Optional, Union
+from typing import Tuple, NamedTuple, List, Optional, Union, Iterator, Iterable
+from collections import deque
+from collections.abc import Mapping
 from sparse_dot_topn import awesome_cossim_topn
-from functools import wraps
+from functools import wraps, lru_cache, partial
+from contextlib import contextmanager
+from concurrent.futures import ThreadPoolExecutor, ProcessPoolExecutor
 import warnings
 
+try:
+    import resource
+except ImportError:  # (not available on Windows)
+    resource = None
+try:
+    import pyarrow as pa
+except ImportError:  # (pyarrow is optional: it is only needed for Arrow-backed strings)
+    pa = None
+try:
+    from multiprocessing import shared_memory
+except ImportError:  # (Python < 3.8)
+    shared_memory = None
+
 DEFAULT_NGRAM_SIZE: int = 3
 DEFAULT_REGEX: str = r'[,-./]|\s'
+DEFAULT_REGEX_CHARACTERS: str = ',-./' + \
+    '\t\n\x0b\x0c\r\x1c\x1d\x1e\x1f \x85\xa0\u1680\u2000\u2001\u2002\u2003\u2004\u2005\u2006\u2007\u2008\u2009' \
+    '\u200a\u2028\u2029\u202f\u205f\u3000'  # the characters matched by DEFAULT_REGEX ('\s' matches those for which
+                                            # str.isspace() is True)
 DEFAULT_MAX_N_MATCHES: int = 20
 DEFAULT_MIN_SIMILARITY: float = 0.8  # minimum cosine similarity for an item to be considered a match
 DEFAULT_N_PROCESSES: int = multiprocessing.cpu_count() - 1
@@ -28,6 +60,34 @@ GROUP_REP_CENTROID: str = 'centroid'    # Option value to select the string in e
                                         # similarity aggregate as group-representative:
 GROUP_REP_FIRST: str = 'first'  # Option value to select the first string in each group as group-representative:
 DEFAULT_GROUP_REP: str = GROUP_REP_CENTROID # chooses group centroid as group-representative by default
+DEFAULT_FEATURE_HASHING: bool = False   # builds a vocabulary of all n-grams by default (no feature hashing)
+DEFAULT_HASH_BITS: int = 20 # when feature hashing, n-grams are hashed into 2^20 columns by default
+MAX_HASH_BITS: int = 31 # column indices of scipy sparse matrices must fit into 32-bit integers
+ENGINE_SPARSE_DOT_TOPN: str = 'sparse_dot_topn' # Option value to compute cosine similarities with sparse_dot_topn
+ENGINE_SYMMETRIC: str = 'symmetric' # Option value to evaluate each pair of strings only once when matching a Series
+                                    # with itself (falls back to sparse_dot_topn otherwise)
+ENGINE_PRUNED: str = 'pruned'   # Option value to only evaluate pairs of strings whose similarity may exceed
+                                # min_similarity (falls back to sparse_dot_topn if min_similarity <= 0)
+ENGINE_BLOCKED: str = 'blocked' # Option value to compute cosine similarities in tiles whose accumulators fit the L2
+                                # cache, selecting the top-n matches tile by tile
+ENGINE_LSH: str = 'lsh' # Option value to only evaluate pairs of strings whose MinHash signatures collide in a band
+                        # (approximate: some matches may be missed)
+DEFAULT_ENGINE: str = ENGINE_SPARSE_DOT_TOPN    # computes cosine similarities with sparse_dot_topn by default
+DEFAULT_TILE_SIZE: Optional[int] = None # matches all strings at once by default (no out-of-core tiling)
+DEFAULT_SPILL_DIR: Optional[str] = None # when tiling, partial results are spilled to a temporary directory by default
+DTYPE_FLOAT32: str = 'float32'  # Option value to compute TF-IDF weights and cosine similarities in single precision
+DTYPE_FLOAT64: str = 'float64'  # Option value to compute TF-IDF weights and cosine similarities in double precision
+DEFAULT_DTYPE: str = DTYPE_FLOAT64  # computes in double precision by default
+DEFAULT_MAX_IDF_DRIFT: float = 0.05 # StringGrouper.update refits once the IDF of any n-gram would change by over 5%
+DEFAULT_COLLECT_STATS: bool = False # does not record the time and memory used by each stage by default
+DEFAULT_LSH_BANDS: int = 20 # when engine='lsh', MinHash signatures are split into 20 bands by default
+DEFAULT_LSH_ROWS: int = 5   # when engine='lsh', each band holds 5 MinHash values by default
+DEFAULT_LSH_MAX_BUCKET_SIZE: Optional[int] = None   # when engine='lsh', no bucket is skipped for its size by default
+PARALLELISM_THREADS: str = 'threads'    # Option value to compute cosine similarities on number_of_processes threads
+PARALLELISM_PROCESSES: str = 'processes'    # Option value to compute cosine similarities on number_of_processes
+                                            # worker processes sharing the TF-IDF matrices
+DEFAULT_PARALLELISM: str = PARALLELISM_THREADS  # computes cosine similarities on threads by default
+DEFAULT_COLLAPSE_DUPLICATES: bool = False   # vectorizes and matches every copy of repeated strings by default
 
 # The following string constants are used by (but aren't [yet] options passed to) StringGrouper
 DEFAULT_COLUMN_NAME: str = 'side'   # used to name non-index columns of the output of StringGrouper.get_matches
@@ -40,6 +100,28 @@ DEFAULT_MASTER_NAME: str = 'master' # used to name non-index column of the outpu
 DEFAULT_MASTER_ID_NAME: str = f'{DEFAULT_MASTER_NAME}_{DEFAULT_ID_NAME}'    # used to name id-column of the output of
                                                                             # StringGrouper.get_nearest_matches
 GROUP_REP_PREFIX: str = 'group_rep_'    # used to prefix and name columns of the output of StringGrouper._deduplicate
+DEFAULT_CHUNKSIZE: int = 100000 # maximum number of rows per chunk of the output of StringGrouper.iter_matches
+CODE_POINT_BITS: int = 21   # number of bits needed to store any unicode code point
+MAX_PACKED_NGRAM_SIZE: int = 3  # largest n-gram whose code points fit (losslessly) into one 64-bit integer code
+FIBONACCI_HASH_MULTIPLIER: int = 0x9E3779B97F4A7C15 # 2^64 / golden ratio, used to hash n-gram codes into columns
+SELF_JOIN_BLOCK_SIZE: int = 2**12   # number of strings per block of the symmetric (self-join) engine
+NEAREST_BLOCK_SIZE: int = 2**12 # number of strings per block of the top-1 (nearest match) kernel
+PRUNED_BLOCK_SIZE: int = 2**12  # number of master strings per block of the pruned engine
+ACCUMULATOR_ROWS: int = 2**10  # number of master strings per tile of the blocked engine
+ACCUMULATOR_COLUMNS: int = 2**14   # number of duplicates strings per tile of the blocked engine (the accumulator of
+                                # a row of a tile then takes up about 200 KiB, which fits into an L2 cache)
+PRUNING_TOLERANCE: float = 1e-6 # slack of the upper bounds of the pruned engine against rounding errors
+SAVE_FORMAT_VERSION: int = 4    # version of the on-disk layout written by StringGrouper.save (2: with nearest_only,
+                                # 3: with block_by, 4: with the strings as UTF-8 bytes)
+MAX_ARROW_CHUNK_BYTES: int = 2**31 - 1  # largest number of bytes of one chunk of Arrow strings (32-bit offsets)
+MINHASH_PRIME: int = 2**31 - 1  # modulus of the universal hash functions (a * x + b) mod p of the MinHash signatures
+MINHASH_SEED: int = 0   # seed of the coefficients of the MinHash hash functions (so that engine='lsh' is repeatable)
+BAND_HASH_MULTIPLIER: int = 1000003 # combines the MinHash values of a band into one 64-bit bucket key
+BATCH_UNION_RATIO: int = 16    # union_many unites pairs one at a time unless there are more than 1/16 as many pairs as
+                                # integers (beyond which a single O(n) pass with connected_components is faster)
+LSH_CANDIDATE_CHUNK_SIZE: int = 2**22   # number of candidate pairs whose similarities the lsh engine computes at once
+SHARDS_PER_PROCESS: int = 4 # number of shards of master rows per worker process (to balance uneven shards)
+MIN_PARTITION_SIZE: int = 2**14 # smallest number of strings per partition of parallel tokenization
 
 # High level functions
 
@@ -60,6 +142,7 @@ def compute_pairwise_similarities(string_series_1: pd.Series,
 
 def group_similar_strings(strings_to_group: pd.Series,
                           string_ids: Optional[pd.Series] = None,
+                          block_by: Optional[pd.Series] = None,
                           **kwargs) -> Union[pd.DataFrame, pd.Series]:
     """
     If 'string_ids' is not given, finds all similar strings in 'strings_to_group' and returns a Series of
@@ -73,10 +156,12 @@ def group_similar_strings(strings_to_group: pd.Series,
 
     :param strings_to_group: pandas.Series. The input Series of strings to be grouped.
     :param string_ids: pandas.Series. The input Series of the IDs of the strings to be grouped. (Optional)
+    :param block_by: pandas.Series. The blocking key of each string to be grouped: only strings with the same key
+    are compared. (Optional)
     :param kwargs: All other keyword arguments are passed to StringGrouperConfig. (Optional)
     :return: pandas.Series or pandas.DataFrame.
     """
-    string_grouper = StringGrouper(strings_to_group, master_id=string_ids, **kwargs).fit()
+    string_grouper = StringGrouper(strings_to_group, master_id=string_ids, block_by=block_by, **kwargs).fit()
     return string_grouper.get_groups()
 
 
@@ -109,7 +194,7 @@ def match_most_similar(master: pd.Series,
                                    duplicates=duplicates,
                                    master_id=master_id,
                                    duplicates_id=duplicates_id,
-                                   **kwargs).fit()
+                                   **kwargs).fit(nearest_only=True)
     return string_grouper.get_groups()
 
 
@@ -117,6 +202,8 @@ def match_strings(master: pd.Series,
                   duplicates: Optional[pd.Series] = None,
                   master_id: Optional[pd.Series] = None,
                   duplicates_id: Optional[pd.Series] = None,
+                  block_by: Optional[pd.Series] = None,
+                  duplicates_block_by: Optional[pd.Series] = None,
                   **kwargs) -> pd.DataFrame:
     """
     Returns all highly similar strings. If only 'master' is given, it will return highly similar strings within master.
@@ -127,6 +214,10 @@ def match_strings(master: pd.Series,
     :param duplicates: pandas.Series. Series of strings that will be matched with master if given (Optional).
     :param master_id: pandas.Series. Series of values that are IDs for master column rows (Optional).
     :param duplicates_id: pandas.Series. Series of values that are IDs for duplicates column rows (Optional).
+    :param block_by: pandas.Series. Series of the blocking keys of master: only strings with the same key are
+    matched (Optional).
+    :param duplicates_block_by: pandas.Series. Series of the blocking keys of duplicates.  Must be given together
+    with block_by when duplicates is given (Optional).
     :param kwargs: All other keyword arguments are passed to StringGrouperConfig.
     :return: pandas.Dataframe.
     """
@@ -134,10 +225,34 @@ def match_strings(master: pd.Series,
                                    duplicates=duplicates,
                                    master_id=master_id,
                                    duplicates_id=duplicates_id,
+                                   block_by=block_by,
+                                   duplicates_block_by=duplicates_block_by,
                                    **kwargs).fit()
     return string_grouper.get_matches()
 
 
+def lsh_recall(master: pd.Series,
+               duplicates: Optional[pd.Series] = None,
+               **kwargs) -> float:
+    """
+    Measures the recall of engine='lsh', that is, the fraction of the matches found by the exact engine
+    (sparse_dot_topn) that engine='lsh' also finds with the same options.  Use it on a sample of the data to choose
+    lsh_bands, lsh_rows and lsh_max_bucket_size.
+
+    :param master: pandas.Series. Series of strings against which matches are calculated.
+    :param duplicates: pandas.Series. Series of strings that will be matched with master if given (Optional).
+    :param kwargs: All other keyword arguments are passed to StringGrouperConfig (except engine).
+    :return: float.  The recall, from 0 to 1 (1 if there are no exact matches).
+    """
+    kwargs = {key: value for key, value in kwargs.items() if key != 'engine'}
+    exact = StringGrouper(master, duplicates, engine=ENGINE_SPARSE_DOT_TOPN, **kwargs).fit()._matches_list
+    if len(exact) == 0:
+        return 1.0
+    approximate = StringGrouper(master, duplicates, engine=ENGINE_LSH, **kwargs).fit()._matches_list
+    found = exact[['master_side', 'dupe_side']].merge(approximate[['master_side', 'dupe_side']], how='inner')
+    return len(found) / len(exact)
+
+
 class StringGrouperConfig(NamedTuple):
     """
     Class with configuration variables.
@@ -159,6 +274,42 @@ class StringGrouperConfig(NamedTuple):
     corresponding duplicates-index values. Defaults to False.
     :param group_rep: str.  The scheme to select the group-representative.  Default is 'centroid'.
     The other choice is 'first'.
+    :param feature_hashing: bool.  Whether or not to hash n-grams straight into a fixed number of columns instead of
+    building a vocabulary of all n-grams.  Defaults to False.
+    :param hash_bits: int.  When feature_hashing=True, n-grams are hashed into 2^hash_bits columns.  Default is 20.
+    :param engine: str.  The algorithm used to compute the cosine similarities.  Default is 'sparse_dot_topn'.
+    The other choices are 'symmetric', which computes each similarity only once when master is matched with itself,
+    and 'pruned', which skips pairs of strings whose similarity cannot exceed min_similarity (if it is positive),
+    'lsh', which only computes the similarities of pairs of strings whose MinHash signatures collide (approximate),
+    and 'blocked', which computes the similarities in cache-sized tiles and keeps only the top-n of each tile.
+    :param tile_size: int.  If set, the strings are matched in tiles of tile_size master strings by tile_size
+    duplicates strings (by the configured engine), whose partial results are spilled to disk and merged afterwards,
+    so that the matches need not fit into memory (the TF-IDF matrices still do).  Cannot be combined with block_by,
+    collapse_duplicates=True or engine='symmetric'.  Defaults to None (no tiling).
+    :param spill_dir: str.  The directory in which tiled matching spills its (partial) results.  Defaults to None
+    (the system's temporary directory).
+    :param max_idf_drift: float.  The largest relative change of the IDF of any n-gram that strings added by update
+    may cause before StringGrouper is refit from scratch.  Default is 0.05.
+    :param dtype: str.  The floating point type of the TF-IDF matrices and the cosine similarities.  Default is
+    'float64'.  The other choice is 'float32', which halves the memory of the matrices and matches (the TF-IDF
+    weights are computed in float32 too, so no float64 copy of the matrices is ever made).
+    :param collect_stats: bool.  Whether or not to record the wall time, CPU time, increase of peak memory, and
+    matrix shapes and nonzeros of each stage of fit, get_matches and get_groups in StringGrouper.stats (and the peak
+    memory traced during each stage, while tracemalloc is tracing).
+    Defaults to False.
+    :param lsh_bands: int.  When engine='lsh', the number of bands of the MinHash signatures.  More bands find more
+    matches (higher recall) and evaluate more pairs.  Default is 20.
+    :param lsh_rows: int.  When engine='lsh', the number of MinHash values per band.  More rows evaluate fewer pairs
+    and find fewer matches.  Default is 5.
+    :param lsh_max_bucket_size: int.  When engine='lsh', buckets (strings whose signatures agree on a band) of more
+    master or duplicates strings than this are skipped, which bounds the work spent on very common n-grams at the
+    cost of recall.  Defaults to None (no bucket is skipped).
+    :param parallelism: str.  How the cosine similarities of engine 'sparse_dot_topn' are spread over
+    number_of_processes.  Default is 'threads'.  The other choice is 'processes', which shards the master strings
+    across worker processes that read the TF-IDF matrices from shared memory (requires Python 3.8 or later).
+    :param collapse_duplicates: bool.  Whether or not to vectorize and match only one copy of each string (after
+    ignoring case and removing regex matches, as n_grams does) and to expand the matches back to all copies
+    afterwards.  The matches are the same either way.  Defaults to False.
     """
 
     ngram_size: int = DEFAULT_NGRAM_SIZE
@@ -172,6 +323,19 @@ class StringGrouperConfig(NamedTuple):
     suppress_warning: bool = DEFAULT_SUPPRESS_WARNING
     replace_na: bool = DEFAULT_REPLACE_NA
     group_rep: str = DEFAULT_GROUP_REP
+    feature_hashing: bool = DEFAULT_FEATURE_HASHING
+    hash_bits: int = DEFAULT_HASH_BITS
+    engine: str = DEFAULT_ENGINE
+    tile_size: Optional[int] = DEFAULT_TILE_SIZE
+    spill_dir: Optional[str] = DEFAULT_SPILL_DIR
+    max_idf_drift: float = DEFAULT_MAX_IDF_DRIFT
+    dtype: str = DEFAULT_DTYPE
+    collect_stats: bool = DEFAULT_COLLECT_STATS
+    lsh_bands: int = DEFAULT_LSH_BANDS
+    lsh_rows: int = DEFAULT_LSH_ROWS
+    lsh_max_bucket_size: Optional[int] = DEFAULT_LSH_MAX_BUCKET_SIZE
+    parallelism: str = DEFAULT_PARALLELISM
+    collapse_duplicates: bool = DEFAULT_COLLAPSE_DUPLICATES
 
 
 def validate_is_fit(f):
@@ -194,11 +358,926 @@ class StringGrouperNotFitException(Exception):
     pass
 
 
+@lru_cache(maxsize=None)
+def _default_regex_code_points() -> np.ndarray:
+    """Returns the (sorted) code points of all characters removed by DEFAULT_REGEX"""
+    return np.array(sorted(map(ord, DEFAULT_REGEX_CHARACTERS)), dtype=np.uint32)
+
+
+def _map_partitions(function, strings: pd.Series, n_jobs: int = 1, use_processes: bool = False) -> list:
+    """
+    Returns [function(partition) for each partition] of up to n_jobs consecutive partitions of strings (of at least
+    MIN_PARTITION_SIZE strings each), computed concurrently on threads or, if use_processes, on worker processes
+    (which function must then be picklable for)
+    """
+    n_partitions = max(1, min(n_jobs, len(strings) // MIN_PARTITION_SIZE))
+    if n_partitions == 1:
+        return [function(strings)]
+    partitions = [strings.iloc[start:stop] for start, stop in _tiles(len(strings), -(-len(strings) // n_partitions))]
+    return _map_concurrently(function, partitions, n_partitions, use_processes)
+
+
+def _map_concurrently(function, items: list, n_jobs: int = 1, use_processes: bool = False) -> list:
+    """Returns [function(item) for item in items] computed on n_jobs threads (or worker processes)"""
+    if n_jobs <= 1 or len(items) <= 1:
+        return [function(item) for item in items]
+    executor_class = ProcessPoolExecutor if use_processes else ThreadPoolExecutor
+    with executor_class(max_workers=min(n_jobs, len(items))) as executor:
+        return list(executor.map(function, items))
+
+
+def _imap_concurrently(function, items: list, n_jobs: int = 1) -> Iterator:
+    """
+    Yields function(item) for item in items in order, computed on n_jobs threads.  At most 2 * n_jobs items are
+    computed ahead of the one being consumed, so that the results need not be held all at once.
+    """
+    if n_jobs <= 1 or len(items) <= 1:
+        yield from map(function, items)
+        return
+    with ThreadPoolExecutor(max_workers=min(n_jobs, len(items))) as executor:
+        pending = deque()
+        for item in items:
+            pending.append(executor.submit(function, item))
+            if len(pending) > 2 * n_jobs:
+                yield pending.popleft().result()
+        while pending:
+            yield pending.popleft().result()
+
+
+def _n_gram_codes(strings: pd.Series,
+                  ngram_size: int,
+                  regex: str,
+                  ignore_case: bool) -> Tuple[np.ndarray, np.ndarray, int]:
+    """
+    Tokenizes a whole Series of strings at once into the same n-grams as StringGrouper.n_grams, but represents each
+    n-gram by a 64-bit integer code (its code points packed CODE_POINT_BITS bits apart) instead of a str.
+
+    For ngram_size <= MAX_PACKED_NGRAM_SIZE the codes are lossless and sort in the same order as the n-gram strings
+    themselves.  Larger n-grams are represented by a rolling hash of all their code points (see _pack_n_grams).
+
+    Arrow-backed strings (see _arrow_strings) are read straight from their contiguous UTF-8 buffer.
+
+    :return: tuple of (n-gram codes, document number of each n-gram, number of documents)
+    """
+    n_docs = len(strings)
+    arrow_strings = _arrow_strings(strings)
+    if arrow_strings is not None and regex != DEFAULT_REGEX:
+        # arbitrary regexes are applied by python's re, as for object strings (Arrow's RE2 has another syntax and
+        # ASCII-only character classes), so these strings are converted to python strings first:
+        strings, arrow_strings = pd.Series(arrow_strings.to_pylist(), dtype=object), None
+    if arrow_strings is not None:
+        chars, lengths = _arrow_code_points(arrow_strings, ignore_case)
+    else:
+        if ignore_case:
+            strings = strings.str.lower()
+        if regex != DEFAULT_REGEX:
+            # arbitrary regexes can only be applied by python's re module:
+            strings = strings.str.replace(regex, '', regex=True)
+        lengths = strings.str.len().to_numpy(dtype=np.int64)
+        chars = np.frombuffer(
+            ''.join(strings.tolist()).encode('utf-32-le', errors='surrogatepass'),
+            dtype=np.uint32
+        )
+    if regex == DEFAULT_REGEX:
+        # DEFAULT_REGEX only ever matches single characters, so it can be applied to all strings at once:
+        keep = ~np.isin(chars, _default_regex_code_points())
+        doc_of_char = np.repeat(np.arange(n_docs), lengths)
+        lengths = np.bincount(doc_of_char[keep], minlength=n_docs).astype(np.int64)
+        chars = chars[keep]
+    return _pack_n_grams(chars, lengths, ngram_size) + (n_docs, )
+
+
+def _concatenate_n_gram_codes(
+        partitions: List[Tuple[np.ndarray, np.ndarray, int]]
+) -> Tuple[np.ndarray, np.ndarray, int]:
+    """Concatenates the outputs of _n_gram_codes for consecutive partitions of a Series into that of the Series"""
+    if len(partitions) == 1:
+        return partitions[0]
+    n_docs = [n for _, _, n in partitions]
+    doc_offsets = np.cumsum(n_docs) - n_docs
+    codes = np.concatenate([codes for codes, _, _ in partitions])
+    doc_ids = np.concatenate([doc_ids + offset for (_, doc_ids, _), offset in zip(partitions, doc_offsets)])
+    return codes, doc_ids, int(sum(n_docs))
+
+
+def _arrow_strings(strings: pd.Series) -> Optional['pa.ChunkedArray']:
+    """Returns the Arrow array of a Series of Arrow-backed strings (string[pyarrow] or ArrowDtype), otherwise None"""
+    if pa is None:
+        return None
+    dtype = strings.dtype
+    is_arrow_string = isinstance(dtype, pd.StringDtype) and str(dtype.storage).startswith('pyarrow')
+    if isinstance(dtype, getattr(pd, 'ArrowDtype', ())):
+        is_arrow_string = pa.types.is_string(dtype.pyarrow_dtype) or pa.types.is_large_string(dtype.pyarrow_dtype)
+    if not is_arrow_string:
+        return None
+    array = strings.array.__arrow_array__()
+    return pa.chunked_array([array]) if isinstance(array, pa.Array) else array
+
+
+def _arrow_code_points(strings: 'pa.ChunkedArray', ignore_case: bool) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Returns the code points of all (lowercased if ignore_case) Arrow strings concatenated, and the number of code
+    points of each string.  The code points are decoded from the UTF-8 buffer of the strings with numpy, so no Python
+    object is created per string (except to lowercase strings that are not pure ASCII).
+    """
+    import pyarrow.compute as pc
+    array = strings.combine_chunks() if strings.num_chunks != 1 else strings.chunk(0)
+    if ignore_case:
+        # Arrow's utf8_lower only agrees with str.lower on ASCII (str.lower maps 'İ' to 'i̇' and a final 'Σ' to 'ς',
+        # for instance), so the strings that are not pure ASCII are lowercased by python:
+        is_not_ascii = pc.invert(pc.string_is_ascii(array))
+        others = pc.filter(array, is_not_ascii).to_pylist()
+        array = pc.ascii_lower(array)
+        if others:
+            array = pc.replace_with_mask(array, is_not_ascii, pa.array([s.lower() for s in others], type=array.type))
+    offset_type = np.int64 if pa.types.is_large_string(array.type) else np.int32
+    _, offsets_buffer, data_buffer = array.buffers()
+    offsets = np.frombuffer(offsets_buffer, dtype=offset_type)[array.offset:(array.offset + len(array) + 1)] \
+        if offsets_buffer is not None else np.zeros(len(array) + 1, dtype=offset_type)
+    data = np.frombuffer(data_buffer, dtype=np.uint8)[offsets[0]:offsets[-1]] if data_buffer is not None \
+        else np.empty(0, dtype=np.uint8)
+    code_points, starts = _utf8_code_points(data)
+    lengths = np.diff(np.searchsorted(starts, offsets - offsets[0])).astype(np.int64)
+    return code_points, lengths
+
+
+def _utf8_code_points(data: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Decodes valid UTF-8 bytes into code points.  Returns the code points and the byte position of each."""
+    data = data.astype(np.uint32)
+    starts = np.flatnonzero((data & 0xC0) != 0x80)
+    n_bytes = np.diff(np.append(starts, len(data)))
+    # the lead byte of a sequence of 1, 2, 3 or 4 bytes holds 7, 5, 4 or 3 bits of the code point, each
+    # continuation byte 6 more:
+    lead_bits = np.array([0, 0x7F, 0x1F, 0x0F, 0x07], dtype=np.uint32)
+    code_points = data[starts] & lead_bits[n_bytes]
+    for k in range(1, 4):
+        has_byte_k = n_bytes > k
+        code_points[has_byte_k] = (code_points[has_byte_k] << np.uint32(6)) | \
+            (data[starts[has_byte_k] + k] & np.uint32(0x3F))
+    return code_points, starts
+
+
+def _pack_n_grams(chars: np.ndarray, lengths: np.ndarray, ngram_size: int) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Packs the n-grams of the concatenated code points chars (with given document lengths) into integer codes, or
+    hashes them if they are larger than MAX_PACKED_NGRAM_SIZE
+    """
+    n_grams_per_doc = np.maximum(lengths - ngram_size + 1, 0) if ngram_size > 0 else np.zeros_like(lengths)
+    doc_ids = np.repeat(np.arange(len(lengths)), n_grams_per_doc)
+    char_offsets = np.cumsum(lengths) - lengths
+    n_gram_offsets = np.cumsum(n_grams_per_doc) - n_grams_per_doc
+    positions = np.arange(len(doc_ids)) + np.repeat(char_offsets - n_gram_offsets, n_grams_per_doc)
+    chars = chars.astype(np.uint64)
+    codes = np.zeros(len(positions), dtype=np.uint64)
+    if ngram_size <= MAX_PACKED_NGRAM_SIZE:
+        for k in range(ngram_size):
+            codes = codes * np.uint64(1 << CODE_POINT_BITS) + chars[positions + k]
+    else:
+        # shifting by CODE_POINT_BITS per character would push the leading characters out of the 64 bits, so larger
+        # n-grams are combined by a rolling (multiply by an odd constant, then xor) hash of all their characters:
+        for k in range(ngram_size):
+            codes = (codes * np.uint64(FIBONACCI_HASH_MULTIPLIER)) ^ chars[positions + k]
+    return codes, doc_ids
+
+
+def _unpack_n_grams(codes: np.ndarray, ngram_size: int) -> List[str]:
+    """Inverse of _pack_n_grams (for ngram_size <= MAX_PACKED_NGRAM_SIZE)"""
+    shifts = np.arange(ngram_size - 1, -1, -1, dtype=np.uint64) * np.uint64(CODE_POINT_BITS)
+    chars = (codes[:, np.newaxis] >> shifts[np.newaxis, :]) & np.uint64((1 << CODE_POINT_BITS) - 1)
+    text = chars.astype('<u4').tobytes().decode('utf-32-le', errors='surrogatepass')
+    return [text[i:(i + ngram_size)] for i in range(0, len(text), ngram_size)]
+
+
+class _NGramVocabulary(Mapping):
+    """
+    A read-only vocabulary (n-gram -> column) backed by a (possibly memory-mapped) fixed-width unicode array of the
+    n-grams in column order.  The n-gram -> column dictionary is only built if a single n-gram is looked up.
+    """
+
+    def __init__(self, n_grams: np.ndarray):
+        self.n_grams = n_grams
+        self._columns = None
+
+    def __len__(self):
+        return len(self.n_grams)
+
+    def __iter__(self):
+        return iter(self.n_grams.tolist())
+
+    def __getitem__(self, n_gram: str) -> int:
+        if self._columns is None:
+            self._columns = {g: i for i, g in enumerate(self.n_grams.tolist())}
+        return self._columns[n_gram]
+
+
+class NGramTfidfVectorizer(object):
+    """
+    Vectorizes strings into the same TF-IDF matrices (vocabulary, IDF and l2-normalized rows) as
+    TfidfVectorizer(min_df=1, analyzer=analyzer), where analyzer is StringGrouper.n_grams.  Instead of calling the
+    analyzer once per string, it tokenizes the whole input Series in bulk with numpy (see _n_gram_codes) whenever the
+    n-grams fit into 64-bit codes.  For n-grams larger than MAX_PACKED_NGRAM_SIZE the n-grams are counted by
+    sklearn's CountVectorizer with the analyzer itself.  The IDF is computed and applied here, as sklearn's smoothed
+    IDF, so only sklearn's public API is used.
+
+    Large inputs are split into up to n_jobs partitions which are tokenized concurrently (on worker processes if
+    use_processes, otherwise on threads).  When transforming, each partition is then looked up in the vocabulary
+    into its own csr block, and the blocks are stacked.
+    """
+
+    def __init__(self,
+                 analyzer=None,
+                 ngram_size: int = DEFAULT_NGRAM_SIZE,
+                 regex: str = DEFAULT_REGEX,
+                 ignore_case: bool = DEFAULT_IGNORE_CASE,
+                 dtype=np.float64,
+                 n_jobs: int = 1,
+                 use_processes: bool = False):
+        self.analyzer = analyzer
+        self.ngram_size = ngram_size
+        self.regex = regex
+        self.ignore_case = ignore_case
+        self.dtype = dtype
+        self.n_jobs = n_jobs
+        self.use_processes = use_processes
+        self.vocabulary_: Optional[Mapping] = None
+        self.idf_: Optional[np.ndarray] = None
+
+    def fit(self, raw_documents) -> 'NGramTfidfVectorizer':
+        """Builds the vocabulary and computes the IDF of all given strings"""
+        self.fit_transform(raw_documents)
+        return self
+
+    def transform(self, raw_documents) -> csr_matrix:
+        """Returns the (l2-normalized) TF-IDF matrix of the strings over the fitted vocabulary"""
+        if self.idf_ is None:
+            raise StringGrouperNotFitException('The NGramTfidfVectorizer must be fit before transforming.')
+        return self._weigh(self._count_vocab(raw_documents, fixed_vocab=True))
+
+    def fit_transform(self, raw_documents) -> csr_matrix:
+        """Builds the vocabulary and computes the IDF of all given strings, and returns their TF-IDF matrix"""
+        counts = self._count_vocab(raw_documents, fixed_vocab=False)
+        document_frequency = np.bincount(counts.indices, minlength=counts.shape[1])
+        # same (smoothed) IDF as sklearn's TfidfVectorizer:
+        self.idf_ = np.log((1 + counts.shape[0]) / (1 + document_frequency)) + 1
+        return self._weigh(counts)
+
+    def _weigh(self, counts: csr_matrix) -> csr_matrix:
+        # (weighed with a diagonal matrix product, as sklearn does, so the rows are bit-for-bit the same, and in dtype
+        # from the start, so no float64 copy of the counts is made when dtype is float32)
+        weighted = counts.astype(self.dtype, copy=False) @ diags(self.idf_.astype(self.dtype), format='csr')
+        return normalize(weighted, norm='l2', copy=False)
+
+    def _count_vocab(self, raw_documents, fixed_vocab: bool) -> csr_matrix:
+        """
+        Returns the n-gram counts of the strings (in sorted vocabulary order).  Unless fixed_vocab, the vocabulary
+        is built from the strings first.
+        """
+        if not (1 <= self.ngram_size <= MAX_PACKED_NGRAM_SIZE):
+            vectorizer = CountVectorizer(analyzer=self.analyzer,
+                                         vocabulary=self.vocabulary_ if fixed_vocab else None,
+                                         dtype=self.dtype)
+            counts = vectorizer.transform(raw_documents) if fixed_vocab else vectorizer.fit_transform(raw_documents)
+            if not fixed_vocab:
+                self.vocabulary_ = vectorizer.vocabulary_
+            return counts
+        if not isinstance(raw_documents, pd.Series):
+            raw_documents = pd.Series(list(raw_documents), dtype=object)
+        n_gram_codes = partial(_n_gram_codes, ngram_size=self.ngram_size, regex=self.regex,
+                               ignore_case=self.ignore_case)
+        partitions = _map_partitions(n_gram_codes, raw_documents, self.n_jobs, self.use_processes)
+        if fixed_vocab:
+            # (the lookup table is built once, before the partitions are looked up concurrently)
+            self._lookup_features(np.empty(0, dtype=np.uint64))
+            blocks = _map_concurrently(self._count_fixed_vocab, partitions, self.n_jobs)
+            return blocks[0] if len(blocks) == 1 else vstack(blocks, format='csr')
+        codes, doc_ids, n_docs = _concatenate_n_gram_codes(partitions)
+        feature_codes, feature_ids = np.unique(codes, return_inverse=True)
+        vocabulary = dict(zip(_unpack_n_grams(feature_codes, self.ngram_size), range(len(feature_codes))))
+        if not vocabulary:
+            raise ValueError("empty vocabulary; perhaps the documents only contain stop words")
+        X = csr_matrix(
+            (np.ones(len(feature_ids), dtype=self.dtype), (doc_ids, feature_ids)),
+            shape=(n_docs, len(vocabulary))
+        )
+        X.sort_indices()
+        self.vocabulary_ = vocabulary
+        return X
+
+    def _count_fixed_vocab(self, partition: Tuple[np.ndarray, np.ndarray, int]) -> csr_matrix:
+        """Returns the n-gram counts of one tokenized partition (see _n_gram_codes) over the fitted vocabulary"""
+        codes, doc_ids, n_docs = partition
+        feature_ids, found = self._lookup_features(codes)
+        X = csr_matrix(
+            (np.ones(len(feature_ids), dtype=self.dtype), (doc_ids[found], feature_ids)),
+            shape=(n_docs, len(self.vocabulary_))
+        )
+        X.sort_indices()
+        return X
+
+    def _lookup_features(self, codes: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+        """Returns the vocabulary ids of the n-gram codes found in the vocabulary, as well as a mask of those found"""
+        if getattr(self, '_sorted_features_of', None) is not self.vocabulary_:
+            if isinstance(self.vocabulary_, _NGramVocabulary):
+                # the unicode array already holds the code points of the n-grams (in column order):
+                n_grams = self.vocabulary_.n_grams
+                ids = np.arange(len(n_grams), dtype=np.int64)
+                chars = np.ascontiguousarray(n_grams).view(np.uint32)
+            else:
+                n_grams = list(self.vocabulary_.keys())
+                ids = np.fromiter(self.vocabulary_.values(), dtype=np.int64, count=len(n_grams))
+                chars = np.frombuffer(''.join(n_grams).encode('utf-32-le', errors='surrogatepass'), dtype=np.uint32)
+            feature_codes, _ = _pack_n_grams(chars, np.full(len(n_grams), self.ngram_size), self.ngram_size)
+            order = np.argsort(feature_codes)
+            self._sorted_feature_codes, self._sorted_feature_ids = feature_codes[order], ids[order]
+            self._sorted_features_of = self.vocabulary_
+        positions = np.searchsorted(self._sorted_feature_codes, codes)
+        found = positions < len(self._sorted_feature_codes)
+        found[found] = self._sorted_feature_codes[positions[found]] == codes[found]
+        return self._sorted_feature_ids[positions[found]], found
+
+
+class HashingNGramTfidfVectorizer(object):
+    """
+    Vectorizes strings into TF-IDF matrices of the same n-grams as StringGrouper.n_grams, but hashes each n-gram
+    straight into one of 2^hash_bits columns instead of looking it up in a vocabulary.  Memory use is therefore
+    bounded, and the IDF is computed from the document frequencies of the hashed columns.  (Distinct n-grams that
+    hash into the same column are counted as one.)  Since the columns need no shared vocabulary, large inputs are
+    split into up to n_jobs partitions which are tokenized and hashed into csr blocks concurrently (tokenized on
+    worker processes if use_processes), and the blocks are stacked.
+    """
+
+    def __init__(self,
+                 ngram_size: int = DEFAULT_NGRAM_SIZE,
+                 regex: str = DEFAULT_REGEX,
+                 ignore_case: bool = DEFAULT_IGNORE_CASE,
+                 hash_bits: int = DEFAULT_HASH_BITS,
+                 dtype=np.float64,
+                 n_jobs: int = 1,
+                 use_processes: bool = False):
+        self.ngram_size = ngram_size
+        self.regex = regex
+        self.ignore_case = ignore_case
+        self.hash_bits = hash_bits
+        self.dtype = dtype
+        self.n_jobs = n_jobs
+        self.use_processes = use_processes
+        self.idf_: Optional[np.ndarray] = None
+
+    @property
+    def n_features(self) -> int:
+        return 1 << self.hash_bits
+
+    def fit(self, *string_series: pd.Series) -> 'HashingNGramTfidfVectorizer':
+        """Computes the IDF of all strings in all given Series"""
+        self.fit_transform(*string_series)
+        return self
+
+    def transform(self, strings: pd.Series) -> csr_matrix:
+        """Returns the (l2-normalized) TF-IDF matrix of strings"""
+        return self._weigh(self._count(strings))
+
+    def fit_transform(self, *string_series: pd.Series) -> List[csr_matrix]:
+        """
+        Computes the IDF of all strings in all given Series and returns their TF-IDF matrices (one per Series).
+        Each Series is tokenized only once.
+        """
+        counts = [self._count(strings) for strings in string_series]
+        n_docs = sum(c.shape[0] for c in counts)
+        document_frequency = sum(np.bincount(c.indices, minlength=self.n_features) for c in counts)
+        # same (smoothed) IDF as sklearn's TfidfVectorizer:
+        self.idf_ = np.log((1 + n_docs) / (1 + document_frequency)) + 1
+        return [self._weigh(c) for c in counts]
+
+    def _count(self, strings: pd.Series) -> csr_matrix:
+        n_gram_codes = partial(_n_gram_codes, ngram_size=self.ngram_size, regex=self.regex,
+                               ignore_case=self.ignore_case)
+        partitions = _map_partitions(n_gram_codes, strings, self.n_jobs, self.use_processes)
+        blocks = _map_concurrently(self._hash_partition, partitions, self.n_jobs)
+        return blocks[0] if len(blocks) == 1 else vstack(blocks, format='csr')
+
+    def _hash_partition(self, partition: Tuple[np.ndarray, np.ndarray, int]) -> csr_matrix:
+        """Returns the hashed n-gram counts of one tokenized partition (see _n_gram_codes)"""
+        codes, doc_ids, n_docs = partition
+        columns = (codes * np.uint64(FIBONACCI_HASH_MULTIPLIER)) >> np.uint64(64 - self.hash_bits)
+        counts = csr_matrix(
+            (np.ones(len(columns), dtype=self.dtype), (doc_ids, columns.astype(np.int64))),
+            shape=(n_docs, self.n_features)
+        )
+        counts.sort_indices()
+        return counts
+
+    def _weigh(self, counts: csr_matrix) -> csr_matrix:
+        if self.idf_ is None:
+            raise StringGrouperNotFitException('The HashingNGramTfidfVectorizer must be fit before transforming.')
+        counts.data *= self.idf_.astype(self.dtype, copy=False)[counts.indices]
+        return normalize(counts, norm='l2', copy=False)
+
+
+def _top_n_per_row(rows: np.ndarray,
+                   cols: np.ndarray,
+                   values: np.ndarray,
+                   ntop: int) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Keeps only the ntop largest values in each row of a sparse matrix given as (row, column, value) triplets.
+    Ties are broken in favour of the smallest column.  The result is sorted by row and then by decreasing value.
+    """
+    order = np.lexsort((cols, -values, rows))
+    rows, cols, values = rows[order], cols[order], values[order]
+    rank_in_row = np.arange(len(rows)) - np.searchsorted(rows, rows)
+    keep = rank_in_row < ntop
+    return rows[keep], cols[keep], values[keep]
+
+
+def _max_rss_mb() -> Optional[float]:
+    """Returns the peak resident set size of this process so far in MiB (None if it is not available)"""
+    if resource is None:
+        return None
+    max_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # (ru_maxrss is in bytes on macOS and in KiB elsewhere)
+    return max_rss / 2**20 if sys.platform == 'darwin' else max_rss / 2**10
+
+
+def _csr_row_argmax(indptr: np.ndarray, indices: np.ndarray, data: np.ndarray) -> np.ndarray:
+    """
+    Returns for each row of a csr matrix (given by its arrays) the column of its largest stored value, the smallest
+    such column in case of ties (the columns of a row need not be sorted), or -1 if the row stores no values
+    """
+    n_rows = len(indptr) - 1
+    argmax = np.full(n_rows, -1, dtype=np.int64)
+    non_empty = np.flatnonzero(np.diff(indptr))
+    if len(non_empty) == 0:
+        return argmax
+    # the segments of the non-empty rows are contiguous, so reduceat can work on their start offsets only:
+    starts = indptr[non_empty]
+    row_max = np.maximum.reduceat(data, starts)
+    is_max = data == np.repeat(row_max, np.diff(np.append(starts, len(data))))
+    candidates = np.where(is_max, indices, np.iinfo(np.int64).max)
+    argmax[non_empty] = np.minimum.reduceat(candidates, starts)
+    return argmax
+
+
+def _concatenated_ranges(starts: np.ndarray, lengths: np.ndarray) -> np.ndarray:
+    """Returns the concatenation of range(starts[i], starts[i] + lengths[i]) for all i"""
+    offsets = starts - (np.cumsum(lengths) - lengths)
+    return np.repeat(offsets, lengths) + np.arange(lengths.sum(), dtype=np.int64)
+
+
+def _segment_cumsum(values: np.ndarray, indptr: np.ndarray) -> np.ndarray:
+    """Returns the cumulative sums of values within each row of a csr matrix (given by its indptr)"""
+    cumsum = np.cumsum(values, dtype=np.float64)
+    row_offsets = np.append(0, cumsum)[indptr[:-1]]
+    return cumsum - np.repeat(row_offsets, np.diff(indptr))
+
+
+def _permute_columns(matrix: csr_matrix, new_column: np.ndarray) -> csr_matrix:
+    """Returns a copy of a csr matrix whose column j is moved to new_column[j] (with sorted indices)"""
+    # (the data is copied, since sorting the indices reorders it in place)
+    permuted = csr_matrix((matrix.data.copy(), new_column[matrix.indices], matrix.indptr.copy()), shape=matrix.shape)
+    permuted.sort_indices()
+    return permuted
+
+
+def _pair_dot_products(left: csr_matrix,
+                       right: csr_matrix,
+                       left_rows: np.ndarray,
+                       right_rows: np.ndarray) -> np.ndarray:
+    """
+    Returns the dot products of the rows left[left_rows[i]] and right[right_rows[i]] for all i, by looking up the
+    nonzeros of the right rows among those of the left rows (which must have sorted indices)
+    """
+    if left.nnz == 0:
+        return np.zeros(len(left_rows))
+    n_features = left.shape[1]
+    left_keys = np.repeat(np.arange(left.shape[0], dtype=np.int64), np.diff(left.indptr)) * n_features + left.indices
+    lengths = np.diff(right.indptr)[right_rows]
+    positions = _concatenated_ranges(right.indptr[right_rows].astype(np.int64), lengths)
+    pair = np.repeat(np.arange(len(left_rows)), lengths)
+    keys = left_rows[pair] * n_features + right.indices[positions]
+    found_at = np.minimum(np.searchsorted(left_keys, keys), len(left_keys) - 1)
+    products = np.where(left_keys[found_at] == keys, left.data[found_at] * right.data[positions], 0)
+    return np.bincount(pair, weights=products, minlength=len(left_rows))
+
+
+def _minhash_band_keys(matrix: csr_matrix, a: np.ndarray, b: np.ndarray) -> np.ndarray:
+    """
+    Returns the bucket key of one band of the MinHash signatures of the rows of a csr matrix (its sets of n-gram
+    columns): the minima of the hash functions (a[k] * column + b[k]) mod MINHASH_PRIME over each row, combined into
+    one 64-bit integer.  Empty rows have no signature and get no key (they are left out of the result, which holds
+    the keys of the non-empty rows in order).
+    """
+    nonempty_starts = matrix.indptr[:-1][np.diff(matrix.indptr) > 0]
+    if len(nonempty_starts) == 0:
+        return np.empty(0, dtype=np.uint64)
+    columns = matrix.indices.astype(np.uint64)[:, None] + np.uint64(1)
+    hashes = (columns * a.astype(np.uint64) + b.astype(np.uint64)) % np.uint64(MINHASH_PRIME)
+    signatures = np.minimum.reduceat(hashes, nonempty_starts, axis=0)
+    keys = np.zeros(len(nonempty_starts), dtype=np.uint64)
+    for k in range(signatures.shape[1]):
+        # (overflows wrap around, and colliding keys only add candidates)
+        keys = keys * np.uint64(BAND_HASH_MULTIPLIER) + signatures[:, k]
+    return keys
+
+
+def _bucket_pairs(left_keys: np.ndarray,
+                  right_keys: np.ndarray,
+                  max_bucket_size: Optional[int] = None) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Returns all pairs (i, j) of positions with left_keys[i] == right_keys[j], except those of buckets (equal keys)
+    that hold more than max_bucket_size positions on either side.
+    """
+    left_order = np.argsort(left_keys, kind='stable')
+    right_order = np.argsort(right_keys, kind='stable')
+    sorted_right_keys = right_keys[right_order]
+    keys, left_start, left_count = np.unique(left_keys[left_order], return_index=True, return_counts=True)
+    right_start = np.searchsorted(sorted_right_keys, keys, side='left')
+    right_count = np.searchsorted(sorted_right_keys, keys, side='right') - right_start
+    keep = right_count > 0
+    if max_bucket_size is not None:
+        keep &= (left_count <= max_bucket_size) & (right_count <= max_bucket_size)
+    left_start, left_count = left_start[keep], left_count[keep].astype(np.int64)
+    right_start, right_count = right_start[keep], right_count[keep].astype(np.int64)
+    n_pairs = left_count * right_count
+    bucket = np.repeat(np.arange(len(n_pairs)), n_pairs)
+    within = np.arange(n_pairs.sum()) - np.repeat(np.cumsum(n_pairs) - n_pairs, n_pairs)
+    left = left_order[left_start[bucket] + within // right_count[bucket]]
+    right = right_order[right_start[bucket] + within % right_count[bucket]]
+    return left, right
+
+
+def _share_array(array: np.ndarray) -> Tuple['shared_memory.SharedMemory', Tuple[str, tuple, str]]:
+    """
+    Copies an array into a new block of shared memory.  Returns the block (which the caller must close and unlink)
+    and the spec (name, shape, dtype) with which other processes attach to it.
+    """
+    memory = shared_memory.SharedMemory(create=True, size=max(array.nbytes, 1))
+    np.ndarray(array.shape, dtype=array.dtype, buffer=memory.buf)[...] = array
+    return memory, (memory.name, array.shape, array.dtype.str)
+
+
+def _attach_shared_array(spec: Tuple[str, tuple, str]) -> Tuple['shared_memory.SharedMemory', np.ndarray]:
+    """Attaches to an array shared by _share_array (without copying it)"""
+    name, shape, dtype = spec
+    if sys.version_info >= (3, 13):
+        # only the sharing process registers (and, when it unlinks the memory, unregisters) it for tracking:
+        memory = shared_memory.SharedMemory(name=name, track=False)
+    else:
+        # (attaching registers the memory again with the resource tracker, which worker processes share with the
+        # sharing process, so this is a no-op that must not be undone here: unregistering is left to the unlink of
+        # the sharing process)
+        memory = shared_memory.SharedMemory(name=name)
+    return memory, np.ndarray(shape, dtype=dtype, buffer=memory.buf)
+
+
+def _shared_topn_shard(master_specs: Tuple[tuple, tuple, tuple],
+                       master_shape: Tuple[int, int],
+                       transposed_specs: Tuple[tuple, tuple, tuple],
+                       transposed_shape: Tuple[int, int],
+                       start: int,
+                       stop: int,
+                       ntop: int,
+                       min_similarity: float) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Worker of the process pool of StringGrouper: builds the top-n cosine similarities of the master rows start to
+    stop with sparse_dot_topn, reading both TF-IDF matrices from shared memory, and returns them as (row, column,
+    value) triplets (with rows counted from the first master row)
+    """
+    attached = [_attach_shared_array(spec) for spec in master_specs + transposed_specs]
+    memories = [memory for memory, _ in attached]
+    try:
+        def top_n() -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+            # (the views of the shared memory must be released before it is closed, hence this inner function)
+            arrays = [array for _, array in attached]
+            master = csr_matrix(tuple(arrays[:3]), shape=master_shape, copy=False)
+            transposed = csr_matrix(tuple(arrays[3:]), shape=transposed_shape, copy=False)
+            rows, cols, values = _csr_to_triplets(awesome_cossim_topn(master[start:stop], transposed,
+                                                                      ntop, min_similarity))
+            return rows + start, cols, values.copy()
+
+        return top_n()
+    finally:
+        attached.clear()
+        for memory in memories:
+            memory.close()
+
+
+def _cross_join_groups(rows: np.ndarray,
+                       cols: np.ndarray,
+                       row_inverse: np.ndarray,
+                       col_inverse: np.ndarray) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Expands pairs (rows[k], cols[k]) of groups into all pairs of their members, where row_inverse (col_inverse) maps
+    each row (column) to its group.  Returns the rows and columns of the member pairs, and the number k of the pair
+    of groups each of them was expanded from.
+    """
+    row_members, col_members = np.argsort(row_inverse, kind='stable'), np.argsort(col_inverse, kind='stable')
+    row_count = np.bincount(row_inverse).astype(np.int64)
+    col_count = np.bincount(col_inverse).astype(np.int64)
+    row_start, col_start = np.cumsum(row_count) - row_count, np.cumsum(col_count) - col_count
+    n_pairs = row_count[rows] * col_count[cols]
+    pair = np.repeat(np.arange(len(rows)), n_pairs)
+    within = np.arange(n_pairs.sum()) - np.repeat(np.cumsum(n_pairs) - n_pairs, n_pairs)
+    pair_col_count = col_count[cols][pair]
+    expanded_rows = row_members[row_start[rows][pair] + within // pair_col_count]
+    expanded_cols = col_members[col_start[cols][pair] + within % pair_col_count]
+    return expanded_rows, expanded_cols, pair
+
+
+def _tiles(n: int, tile_size: int) -> List[Tuple[int, int]]:
+    """Splits range(n) into consecutive (start, stop) tiles of tile_size"""
+    bounds = list(range(0, n, tile_size)) + [n]
+    return list(zip(bounds[:-1], bounds[1:]))
+
+
+def _csr_to_triplets(matrix: csr_matrix) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Returns the (row, column, value) triplets of a csr matrix in storage order"""
+    rows = np.repeat(np.arange(matrix.shape[0], dtype=np.int64), np.diff(matrix.indptr))
+    return rows, matrix.indices.astype(np.int64), matrix.data
+
+
+def _spill(directory: str, name: str, rows: np.ndarray, cols: np.ndarray, values: np.ndarray):
+    """Saves (row, column, value) triplets to disk"""
+    for suffix, array in zip(('rows', 'cols', 'values'), (rows, cols, values)):
+        np.save(os.path.join(directory, f'{name}_{suffix}.npy'), array)
+
+
+def _unspill(directory: str, name: str) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Loads (and deletes) the (row, column, value) triplets saved by _spill"""
+    arrays = []
+    for suffix in ('rows', 'cols', 'values'):
+        path = os.path.join(directory, f'{name}_{suffix}.npy')
+        arrays.append(np.load(path))
+        os.remove(path)
+    return tuple(arrays)
+
+
+def _utf8_encode(strings: pd.Series) -> Tuple[np.ndarray, np.ndarray]:
+    """Returns the UTF-8 bytes of all strings concatenated, and the byte offsets of the strings (and of their end)"""
+    encoded = [string.encode('utf-8') for string in strings.tolist()]
+    offsets = np.zeros(len(encoded) + 1, dtype=np.int64)
+    offsets[1:] = np.cumsum(np.fromiter(map(len, encoded), dtype=np.int64, count=len(encoded)))
+    return np.frombuffer(b''.join(encoded), dtype=np.uint8), offsets
+
+
+def _utf8_decode(data: np.ndarray, offsets: np.ndarray, index: pd.Index, name, arrow: bool = True) -> pd.Series:
+    """
+    Inverse of _utf8_encode.  If arrow (and pyarrow is installed), the bytes are wrapped into Arrow-backed strings
+    without being copied, so (memory-mapped) bytes stay shared and each string is only decoded when it is used.
+    Otherwise they are decoded into python strings.
+    """
+    n = len(offsets) - 1
+    if pa is None or not arrow:
+        text = data.tobytes()
+        return pd.Series([text[start:stop].decode('utf-8') for start, stop in zip(offsets[:-1], offsets[1:])],
+                         index=index, name=name, dtype=object)
+    chunks, start = [], 0
+    while start < n or not chunks:
+        stop = int(np.searchsorted(offsets, offsets[start] + MAX_ARROW_CHUNK_BYTES, side='right')) - 1
+        stop = min(max(stop, start + 1), n)
+        chunk_offsets = (offsets[start:(stop + 1)] - offsets[start]).astype(np.int32)
+        chunk_data = data[offsets[start]:offsets[stop]]
+        chunks.append(pa.StringArray.from_buffers(stop - start, pa.py_buffer(chunk_offsets), pa.py_buffer(chunk_data)))
+        start = stop
+    return pd.Series(pd.arrays.ArrowStringArray(pa.chunked_array(chunks, type=pa.string())), index=index, name=name)
+
+
+class _EdgeListWriter(object):
+    """Appends (master_side, dupe_side, similarity) triplets to flat binary files, to be memory-mapped once closed"""
+
+    def __init__(self, directory: str, similarity_dtype):
+        self._paths = [os.path.join(directory, f'edge_list_{column}.bin')
+                       for column in ('master_side', 'dupe_side', 'similarity')]
+        self._dtypes = (np.int64, np.int64, similarity_dtype)
+        self._files = [open(path, 'wb') for path in self._paths]
+        self._size = 0
+
+    def append(self, master_side: np.ndarray, dupe_side: np.ndarray, similarity: np.ndarray):
+        for file, array, dtype in zip(self._files, (master_side, dupe_side, similarity), self._dtypes):
+            array.astype(dtype, copy=False).tofile(file)
+        self._size += len(master_side)
+
+    def close(self) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """Closes the files and returns their (read-only) memory-maps"""
+        for file in self._files:
+            file.close()
+        if self._size == 0:
+            # empty files cannot be memory-mapped:
+            return tuple(np.empty(0, dtype=dtype) for dtype in self._dtypes)
+        return tuple(np.memmap(path, dtype=dtype, mode='r') for path, dtype in zip(self._paths, self._dtypes))
+
+
+class _TopNCandidates(object):
+    """
+    Collects (row, column, value) triplets of a sparse matrix in parts, and prunes them to the ntop largest values of
+    each row whenever more than max_pending triplets have accumulated.
+    """
+
+    def __init__(self, ntop: int, max_pending: int):
+        self._ntop = ntop
+        self._max_pending = max_pending
+        self._parts: List[Tuple[np.ndarray, np.ndarray, np.ndarray]] = []
+        self._size = 0
+
+    def add(self, rows: np.ndarray, cols: np.ndarray, values: np.ndarray):
+        self._parts.append((rows, cols, values))
+        self._size += len(rows)
+        if self._size > self._max_pending:
+            self._prune()
+
+    def top_n(self) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """Returns the triplets of the ntop largest values of each row"""
+        self._prune()
+        return self._parts[0]
+
+    def _prune(self):
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*self._parts))
+        self._parts = [_top_n_per_row(rows, cols, values, self._ntop)]
+        self._size = len(self._parts[0][0])
+
+
+class _DisjointSet(object):
+    """
+    Disjoint sets of the integers 0, ..., n - 1 (union-find with path compression and union by rank).  Single
+    unions take O(α(n)) time; large batches of unions are done at once with scipy's connected_components.
+    """
+
+    def __init__(self, n: int):
+        self._parent = np.arange(n, dtype=np.int64)
+        self._rank = np.zeros(n, dtype=np.int64)
+
+    def find(self, x: int) -> int:
+        """Returns the root (representative) of the set of x"""
+        parent = self._parent
+        root = x
+        while parent[root] != root:
+            root = parent[root]
+        # path compression:
+        while parent[x] != root:
+            parent[x], x = root, parent[x]
+        return int(root)
+
+    def union(self, x: int, y: int):
+        """Unites the sets of x and y"""
+        x, y = self.find(x), self.find(y)
+        if x == y:
+            return
+        if self._rank[x] < self._rank[y]:
+            x, y = y, x
+        self._parent[y] = x
+        if self._rank[x] == self._rank[y]:
+            self._rank[x] += 1
+
+    def union_many(self, xs: np.ndarray, ys: np.ndarray):
+        """
+        Unites the sets of xs[i] and ys[i] for all i: one pair at a time (in place) if there are few pairs, otherwise
+        all at once with connected_components, which takes O(n) time whatever the number of pairs
+        """
+        n = len(self._parent)
+        if len(xs) * BATCH_UNION_RATIO <= n:
+            for x, y in zip(xs.tolist(), ys.tolist()):
+                self.union(x, y)
+            return
+        graph = csr_matrix(
+            (
+                np.ones(n + len(xs), dtype=np.int32),
+                (np.concatenate([np.arange(n), xs]), np.concatenate([self._parent, ys]))
+            ),
+            shape=(n, n)
+        )
+        _, labels = connected_components(csgraph=graph, directed=True)
+        # every set points straight at its smallest member:
+        _, first_members, members_of = np.unique(labels, return_index=True, return_inverse=True)
+        self._parent = first_members[members_of].astype(np.int64)
+        self._rank = np.zeros(n, dtype=np.int64)
+        self._rank[first_members[np.bincount(members_of) > 1]] = 1
+
+    def regroup(self, members: np.ndarray, xs: np.ndarray, ys: np.ndarray):
+        """Splits up members (which must make up whole sets) into the sets which the pairs (xs[i], ys[i]) connect"""
+        self.roots()
+        self._parent[members] = members
+        self._rank[members] = 0
+        self.union_many(xs, ys)
+
+    def roots(self) -> np.ndarray:
+        """Returns the root of the set of every integer (and compresses all paths)"""
+        parent = self._parent
+        while True:
+            grandparent = parent[parent]
+            if np.array_equal(grandparent, parent):
+                break
+            parent = grandparent
+        self._parent = parent
+        return parent
+
+
+class _StringIndex(object):
+    """Hash index of the positions at which each distinct string of a Series occurs"""
+
+    def __init__(self, strings: pd.Series):
+        codes, uniques = pd.factorize(strings)
+        self._strings = pd.Index(uniques)
+        self._positions = np.argsort(codes, kind='stable')
+        self._starts = np.append(0, np.cumsum(np.bincount(codes, minlength=len(uniques))))
+
+    def positions_of(self, strings: pd.Series, error) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Returns the positions of all occurrences of all strings, and the number (in strings) of the string of each.
+        Raises error(string) for the first string that does not occur.
+        """
+        codes = self._strings.get_indexer(strings)
+        if (codes < 0).any():
+            raise error(strings.iloc[np.argmax(codes < 0)])
+        starts = self._starts[codes]
+        lengths = self._starts[codes + 1] - starts
+        return self._positions[_concatenated_ranges(starts, lengths)], np.repeat(np.arange(len(codes)), lengths)
+
+
+class _QueryIndex(object):
+    """
+    Inverted index of the n-grams of master strings for StringGrouper.query: the postings of each n-gram are the
+    master strings containing it, sorted by decreasing (L2-normalized TF-IDF) weight, and its largest weight.
+    """
+
+    def __init__(self, master_matrix: csr_matrix):
+        self._master_matrix = master_matrix
+        postings = master_matrix.tocsc()
+        n_features = postings.shape[1]
+        feature = np.repeat(np.arange(n_features, dtype=np.int64), np.diff(postings.indptr))
+        by_weight = np.lexsort((-postings.data, feature))
+        self._indptr = postings.indptr.astype(np.int64)
+        self._strings = postings.indices[by_weight].astype(np.int64)
+        self._weights = postings.data[by_weight]
+        self._max_weight = np.zeros(n_features, dtype=postings.dtype)
+        has_postings = np.diff(self._indptr) > 0
+        self._max_weight[has_postings] = self._weights[self._indptr[:-1][has_postings]]
+
+    def search(self, query_vector: csr_matrix, k: int, min_similarity: float) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Returns the positions of the (at most) k master strings most similar to query_vector (a 1-row TF-IDF matrix
+        with sorted indices) whose similarities exceed min_similarity, and their similarities, by decreasing
+        similarity.
+
+        MaxScore, term at a time: the n-grams of the query are visited by decreasing upper bound (query weight times
+        largest master weight) and the products of their postings are accumulated into partial similarities, whose
+        k-th largest raises the threshold.  Once the upper bounds of the n-grams left (the non-essential ones) do not
+        exceed the threshold, no string missing from the accumulator can match, so their postings are not traversed:
+        the weights of the strings still in the running are looked up in their own rows instead (unless that costs
+        more than the postings), and a string drops out as soon as its partial similarity plus the bounds left does
+        not exceed the threshold.  Only the strings left at the end are scored exactly.
+        """
+        features, weights = query_vector.indices, query_vector.data
+        bounds = weights * self._max_weight[features]
+        by_bound = np.argsort(-bounds, kind='stable')
+        remaining = np.append(np.cumsum(bounds[by_bound][::-1])[::-1], 0)
+        accumulator = np.zeros(self._master_matrix.shape[0])
+        threshold = min_similarity
+        # essential n-grams: their whole postings are accumulated
+        n_essential = 0
+        while n_essential < len(by_bound) and remaining[n_essential] > threshold - PRUNING_TOLERANCE:
+            term = by_bound[n_essential]
+            start, stop = self._indptr[features[term]], self._indptr[features[term] + 1]
+            strings = self._strings[start:stop]
+            accumulator[strings] += weights[term] * self._weights[start:stop]
+            if len(strings) >= k:
+                threshold = max(threshold, np.partition(accumulator[strings], len(strings) - k)[-k])
+            n_essential += 1
+        # non-essential n-grams: only the candidates met so far are updated
+        candidates = np.flatnonzero(accumulator > threshold - PRUNING_TOLERANCE - remaining[n_essential])
+        for i in range(n_essential, len(by_bound)):
+            if len(candidates) == 0:
+                break
+            term = by_bound[i]
+            start, stop = self._indptr[features[term]], self._indptr[features[term] + 1]
+            row_lengths = self._master_matrix.indptr[candidates + 1] - self._master_matrix.indptr[candidates]
+            if row_lengths.sum() < stop - start:
+                accumulator[candidates] += weights[term] * self._weights_of(candidates, row_lengths, features[term])
+            else:
+                accumulator[self._strings[start:stop]] += weights[term] * self._weights[start:stop]
+            if len(candidates) >= k:
+                threshold = max(threshold, np.partition(accumulator[candidates], len(candidates) - k)[-k])
+            candidates = candidates[accumulator[candidates] > threshold - PRUNING_TOLERANCE - remaining[i + 1]]
+        similarities = _pair_dot_products(
+            query_vector, self._master_matrix, np.zeros(len(candidates), dtype=np.int64), candidates
+        )
+        is_match = similarities > min_similarity
+        candidates, similarities = candidates[is_match], similarities[is_match]
+        best = np.lexsort((candidates, -similarities))[:k]
+        return candidates[best], similarities[best].astype(self._weights.dtype)
+
+    def _weights_of(self, strings: np.ndarray, row_lengths: np.ndarray, feature: int) -> np.ndarray:
+        """Returns the weights of one n-gram in the given master strings (0 where absent), read from their rows"""
+        positions = _concatenated_ranges(self._master_matrix.indptr[strings].astype(np.int64), row_lengths)
+        found = self._master_matrix.indices[positions] == feature
+        string = np.repeat(np.arange(len(strings)), row_lengths)[found]
+        return np.bincount(string, weights=self._master_matrix.data[positions][found], minlength=len(strings))
+
+
 class StringGrouper(object):
     def __init__(self, master: pd.Series,
                  duplicates: Optional[pd.Series] = None,
                  master_id: Optional[pd.Series] = None,
                  duplicates_id: Optional[pd.Series] = None,
+                 block_by: Optional[pd.Series] = None,
+                 duplicates_block_by: Optional[pd.Series] = None,
                  **kwargs):
         """
         StringGrouper is a class that holds the matrix with cosine similarities between the master and duplicates
@@ -210,8 +1289,14 @@ class StringGrouper(object):
         :param duplicates: pandas.Series. If set, for each string in duplicates a similar string is searched in Master.
         :param master_id: pandas.Series. If set, contains ID values for each row in master Series.
         :param duplicates_id: pandas.Series. If set, contains ID values for each row in duplicates Series.
+        :param block_by: pandas.Series. If set, contains the blocking key of each row in master Series: only strings
+        with the same key are matched, one block (of all strings sharing a key) at a time.
+        :param duplicates_block_by: pandas.Series. If set, contains the blocking key of each row in duplicates
+        Series.  Must be set together with block_by when duplicates is given.
         :param kwargs: All other keyword arguments are passed to StringGrouperConfig
         """
+        master = StringGrouper._as_series(master)
+        duplicates = StringGrouper._as_series(duplicates)
         # Validate match strings input
         if not StringGrouper._is_series_of_strings(master) or \
                 (duplicates is not None and not StringGrouper._is_series_of_strings(duplicates)):
@@ -220,18 +1305,66 @@ class StringGrouper(object):
         if not StringGrouper._is_input_data_combination_valid(duplicates, master_id, duplicates_id):
             raise Exception('List of data Series options is invalid')
         StringGrouper._validate_id_data(master, duplicates, master_id, duplicates_id)
+        StringGrouper._validate_block_by_data(master, duplicates, block_by, duplicates_block_by)
 
         self._master: pd.Series = master
         self._duplicates: pd.Series = duplicates if duplicates is not None else None
         self._master_id: pd.Series = master_id if master_id is not None else None
         self._duplicates_id: pd.Series = duplicates_id if duplicates_id is not None else None
+        self._block_by: Optional[pd.Series] = block_by
+        self._duplicates_block_by: Optional[pd.Series] = duplicates_block_by
         self._config: StringGrouperConfig = StringGrouperConfig(**kwargs)
         self._validate_group_rep_specs()
+        self._validate_feature_hashing_specs()
+        self._validate_engine_specs()
+        self._validate_tile_size_specs()
+        self._validate_dtype_specs()
+        self._validate_lsh_specs()
+        self._validate_parallelism_specs()
         self._validate_replace_na_and_drop()
         self.is_build = False  # indicates if the grouper was fit or not
-        self._vectorizer = TfidfVectorizer(min_df=1, analyzer=self.n_grams)
+        use_processes = self._config.parallelism == PARALLELISM_PROCESSES
+        if self._config.feature_hashing:
+            self._vectorizer = HashingNGramTfidfVectorizer(ngram_size=self._config.ngram_size,
+                                                           regex=self._config.regex,
+                                                           ignore_case=self._config.ignore_case,
+                                                           hash_bits=self._config.hash_bits,
+                                                           dtype=np.dtype(self._config.dtype).type,
+                                                           n_jobs=self._config.number_of_processes,
+                                                           use_processes=use_processes)
+        else:
+            self._vectorizer = NGramTfidfVectorizer(analyzer=self.n_grams,
+                                                    ngram_size=self._config.ngram_size,
+                                                    regex=self._config.regex,
+                                                    ignore_case=self._config.ignore_case,
+                                                    dtype=np.dtype(self._config.dtype).type,
+                                                    n_jobs=self._config.number_of_processes,
+                                                    use_processes=use_processes)
         # After the StringGrouper is build, _matches_list will contain the indices and similarities of two matches
         self._matches_list: pd.DataFrame = pd.DataFrame()
+        # The fitted TF-IDF matrices and the document frequency of each n-gram are kept for update:
+        self._master_matrix: Optional[csr_matrix] = None
+        self._duplicate_matrix: Optional[csr_matrix] = None
+        self._document_frequency: Optional[np.ndarray] = None
+        self._n_documents: int = 0
+        # whether only the most similar master string of each duplicate was searched for (see fit):
+        self._nearest_only: bool = False
+        # The groups of master (when there are no duplicates) are kept in a disjoint set, built on first use and
+        # maintained by add_match; remove_match only notes the strings whose groups it may have split:
+        self._disjoint_set: Optional[_DisjointSet] = None
+        self._split_suspects: set = set()
+        # hash indices of the positions of the strings of master and duplicates, built on first use by add_matches
+        # and remove_matches:
+        self._string_indices: Optional[Tuple[_StringIndex, _StringIndex]] = None
+        # inverted index of the n-grams of master, built on first use by query, with the (named) master and
+        # master_id Series it returns rows of:
+        self._query_index: Optional[_QueryIndex] = None
+        self._query_master: Optional[pd.Series] = None
+        self._query_master_id: Optional[pd.Series] = None
+        # If collect_stats=True, stats holds one record (dict) per stage of fit, get_matches and get_groups run:
+        self.stats: List[dict] = []
+        self._open_stages: List[str] = []
+        self._traced_peaks: List[int] = []
 
     def n_grams(self, string: str) -> List[str]:
         """
@@ -246,19 +1379,261 @@ class StringGrouper(object):
         n_grams = zip(*[string[i:] for i in range(ngram_size)])
         return [''.join(n_gram) for n_gram in n_grams]
 
-    def fit(self) -> 'StringGrouper':
-        """Builds the _matches list which contains string matches indices and similarity"""
-        master_matrix, duplicate_matrix = self._get_tf_idf_matrices()
-        # Calculate the matches using the cosine similarity
-        matches = self._build_matches(master_matrix, duplicate_matrix)
-        # retrieve all matches
-        self._matches_list = self._get_matches_list(matches)
-        if self._duplicates is None:
-            # the list of matches needs to be symmetric!!! (i.e., if A != B and A matches B; then B matches A)
-            self._symmetrize_matches_list()
+    def fit(self, nearest_only: bool = False) -> 'StringGrouper':
+        """
+        Builds the _matches list which contains string matches indices and similarity
+
+        :param nearest_only: bool.  If True and duplicates is given, only the most similar master string of each
+        duplicate is searched for (which is all get_groups needs), with a top-1 kernel that keeps a running maximum
+        per duplicate instead of max_n_matches matches per master string.  get_matches then returns only those
+        matches.  Cannot be combined with block_by.  Defaults to False.
+        """
+        if nearest_only and self._duplicates is not None and self._block_by is not None:
+            raise Exception('fit(nearest_only=True) cannot be combined with block_by.')
+        with self._stage('fit'):
+            collapsed = None
+            if self._config.collapse_duplicates:
+                collapsed = self._get_collapsed_tf_idf_matrices()
+                master_matrix, duplicate_matrix = self._expand_collapsed_matrices(*collapsed)
+            else:
+                master_matrix, duplicate_matrix = self._get_tf_idf_matrices()
+            self._master_matrix, self._duplicate_matrix = master_matrix, duplicate_matrix
+            self._query_index = None
+            self._document_frequency = self._get_document_frequency()
+            self._n_documents = len(self._master) + (0 if self._duplicates is None else len(self._duplicates))
+            self._nearest_only = nearest_only and self._duplicates is not None
+            self._disjoint_set, self._split_suspects = None, set()
+            if self._nearest_only:
+                with self._stage('build_nearest_matches') as stage:
+                    self._matches_list = self._build_collapsed_nearest_matches_list(*collapsed) \
+                        if collapsed is not None else self._build_nearest_matches_list(master_matrix, duplicate_matrix)
+                    stage['rows'] = len(self._matches_list)
+            elif self._config.tile_size is not None:
+                # the matches are built and stored on disk tile by tile:
+                with self._stage('build_matches_out_of_core') as stage:
+                    self._matches_list = self._build_matches_list_out_of_core(master_matrix, duplicate_matrix)
+                    stage['rows'] = len(self._matches_list)
+            else:
+                # Calculate the matches using the cosine similarity
+                with self._stage('build_matches') as stage:
+                    if collapsed is not None:
+                        matches = self._build_collapsed_matches(*collapsed)
+                    else:
+                        matches = self._build_matches_within_blocks(master_matrix, duplicate_matrix,
+                                                                    *self._get_block_codes(), self._build_matches)
+                    stage.update(shapes=[matches.shape], nnz=[matches.nnz])
+                if self._duplicates is None:
+                    # the list of matches needs to be symmetric!!! (i.e., if A != B and A matches B; then B matches A)
+                    with self._stage('symmetrize') as stage:
+                        matches = self._symmetrize_matches(matches)
+                        stage.update(shapes=[matches.shape], nnz=[matches.nnz])
+                # retrieve all matches
+                with self._stage('get_matches_list') as stage:
+                    self._matches_list = self._get_matches_list(matches)
+                    stage['rows'] = len(self._matches_list)
         self.is_build = True
         return self
 
+    @validate_is_fit
+    def update(self,
+               new_strings: pd.Series,
+               new_ids: Optional[pd.Series] = None,
+               new_block_by: Optional[pd.Series] = None) -> 'StringGrouper':
+        """
+        Adds new strings to a fitted StringGrouper without refitting it.  If only master was given, the new strings
+        are appended to master and matched against all of master (themselves included), otherwise they are appended
+        to duplicates and matched against master.  The new strings are vectorized with the fitted vocabulary and IDF,
+        and their matches are merged into the existing ones (so matches added by add_match are kept):
+        when matching duplicates, each master string keeps its max_n_matches best matches among old and new ones.
+        The new strings are matched with the configured engine (see StringGrouper._build_matches).  update cannot
+        be combined with collapse_duplicates=True.
+
+        IDF drift: a refit would recompute the IDF of every n-gram over all strings.  So after each update, the IDF
+        of the fitted n-grams is recomputed over the strings fit and all strings added since the last fit; if the
+        IDF of any n-gram changes by more than max_idf_drift (relative to its fitted value), StringGrouper is refit
+        from scratch on all its strings instead, which discards matches added or removed by hand.
+        Until the next refit, n-grams that were not seen during the last fit are ignored (unless feature_hashing=True).
+
+        :param new_strings: pandas.Series.  The strings to add.
+        :param new_ids: pandas.Series.  The IDs of the strings to add.  Must be given if and only if IDs were given.
+        :param new_block_by: pandas.Series.  The blocking keys of the strings to add.  Must be given if and only if
+        block_by was given.
+
+        If both the strings fitted and new_strings have a default index (0, 1, 2, ...), the new strings are
+        relabeled to continue it.  Otherwise the index of new_strings must not share any label with that of the
+        strings fitted, so that no index appears twice in the output.
+        """
+        new_strings = StringGrouper._as_series(new_strings)
+        if not StringGrouper._is_series_of_strings(new_strings):
+            raise TypeError('Input does not consist of pandas.Series containing only Strings')
+        if self._config.collapse_duplicates:
+            raise Exception('update cannot be combined with collapse_duplicates=True (the new strings would have to '
+                            'be collapsed together with the strings fitted).')
+        has_ids = self._master_id is not None
+        if has_ids != (new_ids is not None) or (has_ids and len(new_ids) != len(new_strings)):
+            raise Exception('new_ids must contain one ID for each new string if (and only if) IDs were given.')
+        has_blocks = self._block_by is not None
+        if has_blocks != (new_block_by is not None) or (has_blocks and len(new_block_by) != len(new_strings)):
+            raise Exception('new_block_by must contain one blocking key for each new string if (and only if) '
+                            'block_by was given.')
+        if len(new_strings) == 0:
+            return self
+        new_index = self._get_update_index(self._master if self._duplicates is None else self._duplicates,
+                                           new_strings)
+        new_strings = new_strings.set_axis(new_index)
+        new_ids = new_ids.set_axis(new_index) if has_ids else None
+        new_block_by = new_block_by.set_axis(new_index) if has_blocks else None
+        self._string_indices = None
+        self._query_index = None
+        new_matrix = self._vectorizer.transform(new_strings)
+        self._document_frequency = \
+            self._document_frequency + np.bincount(new_matrix.indices, minlength=new_matrix.shape[1])
+        self._n_documents += len(new_strings)
+        if self._duplicates is None:
+            n_old = len(self._master)
+            self._master = pd.concat([self._master, new_strings.rename(self._master.name)])
+            if has_ids:
+                self._master_id = pd.concat([self._master_id, new_ids.rename(self._master_id.name)])
+            if has_blocks:
+                self._block_by = pd.concat([self._block_by, new_block_by.rename(self._block_by.name)])
+            self._master_matrix = self._duplicate_matrix = vstack([self._master_matrix, new_matrix], format='csr')
+        else:
+            n_old = len(self._duplicates)
+            self._duplicates = pd.concat([self._duplicates, new_strings.rename(self._duplicates.name)])
+            if has_ids:
+                self._duplicates_id = pd.concat([self._duplicates_id, new_ids.rename(self._duplicates_id.name)])
+            if has_blocks:
+                self._duplicates_block_by = pd.concat([self._duplicates_block_by,
+                                                       new_block_by.rename(self._duplicates_block_by.name)])
+            self._duplicate_matrix = vstack([self._duplicate_matrix, new_matrix], format='csr')
+        if self._idf_drift() > self._config.max_idf_drift:
+            return self.fit(nearest_only=self._nearest_only)
+        if self._duplicates is None:
+            self._matches_list = self._get_updated_self_join_matches_list(new_matrix, n_old)
+            self._disjoint_set, self._split_suspects = None, set()
+        elif self._nearest_only:
+            new_matches_list = self._build_nearest_matches_list(self._master_matrix, new_matrix)
+            new_matches_list['dupe_side'] += n_old
+            self._matches_list = pd.concat([self._matches_list, new_matches_list], ignore_index=True)
+        else:
+            self._matches_list = self._get_updated_matches_list(new_matrix, n_old)
+        return self
+
+    @staticmethod
+    def _get_update_index(strings: pd.Series, new_strings: pd.Series) -> pd.Index:
+        """Returns the index under which update appends new_strings to strings (see update)"""
+        n, n_new = len(strings), len(new_strings)
+        if strings.index.equals(pd.RangeIndex(n)) and new_strings.index.equals(pd.RangeIndex(n_new)):
+            return pd.RangeIndex(n, n + n_new)
+        if new_strings.index.isin(strings.index).any():
+            raise Exception('The index of new_strings must not share any label with that of the strings fitted '
+                            '(unless both are default indexes).')
+        return new_strings.index
+
+    @validate_is_fit
+    def save(self, path: str) -> 'StringGrouper':
+        """
+        Saves the fitted StringGrouper into the directory path (which is created if need be): its options and state
+        as JSON, the indexes and names of its strings, its IDs and blocking keys pickled, and its strings (as UTF-8
+        bytes and their offsets), vocabulary, IDF, TF-IDF matrices and matches as flat .npy arrays which
+        StringGrouper.load can memory-map.
+
+        :param path: str.  The directory to save into.  Files of an earlier save are overwritten.
+        """
+        os.makedirs(path, exist_ok=True)
+        state = {'format_version': SAVE_FORMAT_VERSION,
+                 'config': self._config._asdict(),
+                 'n_documents': self._n_documents,
+                 'nearest_only': self._nearest_only,
+                 'object_strings': {name: strings.dtype == object for name, strings in
+                                    (('master', self._master), ('duplicates', self._duplicates))
+                                    if strings is not None}}
+        with open(os.path.join(path, 'string_grouper.json'), 'w') as file:
+            json.dump(state, file)
+        pd.to_pickle({'master_index': self._master.index,
+                      'master_name': self._master.name,
+                      'duplicates_index': None if self._duplicates is None else self._duplicates.index,
+                      'duplicates_name': None if self._duplicates is None else self._duplicates.name,
+                      'master_id': self._master_id,
+                      'duplicates_id': self._duplicates_id,
+                      'block_by': self._block_by,
+                      'duplicates_block_by': self._duplicates_block_by},
+                     os.path.join(path, 'labels.pkl'))
+        arrays = {'idf': np.asarray(self._vectorizer.idf_), 'document_frequency': self._document_frequency}
+        for name, strings in (('master', self._master), ('duplicates', self._duplicates)):
+            if strings is not None:
+                arrays[f'{name}_utf8'], arrays[f'{name}_offsets'] = _utf8_encode(strings)
+        if not self._config.feature_hashing:
+            arrays['vocabulary'] = self._get_vocabulary_array()
+        matrices = {'master_matrix': self._master_matrix}
+        if self._duplicates is not None:
+            matrices['duplicate_matrix'] = self._duplicate_matrix
+        for name, matrix in matrices.items():
+            arrays.update({f'{name}_data': matrix.data,
+                           f'{name}_indices': matrix.indices,
+                           f'{name}_indptr': matrix.indptr})
+        for column in ('master_side', 'dupe_side', 'similarity'):
+            arrays[f'matches_{column}'] = self._matches_list[column].to_numpy()
+        for name, array in arrays.items():
+            np.save(os.path.join(path, f'{name}.npy'), array)
+        return self
+
+    @staticmethod
+    def load(path: str, mmap: bool = True) -> 'StringGrouper':
+        """
+        Loads a fitted StringGrouper saved by StringGrouper.save.
+
+        :param path: str.  The directory the StringGrouper was saved into.
+        :param mmap: bool.  If True (the default), the strings, vocabulary, IDF, TF-IDF matrices and matches are
+        memory-mapped (copy-on-write) instead of read into memory, so that processes which load the same path share
+        their pages.  The strings are then Arrow-backed (string[pyarrow]) and only decoded when used, if pyarrow is
+        installed; otherwise, or if mmap is False and they were saved as python strings, they are decoded into python
+        strings.  The indexes, IDs and blocking keys are always unpickled by each process.
+        """
+        with open(os.path.join(path, 'string_grouper.json')) as file:
+            state = json.load(file)
+        if state['format_version'] != SAVE_FORMAT_VERSION:
+            raise Exception(f"Cannot load a StringGrouper saved in format version {state['format_version']} "
+                            f"(only version {SAVE_FORMAT_VERSION} is supported).")
+        labels = pd.read_pickle(os.path.join(path, 'labels.pkl'))
+
+        def load_array(name: str) -> np.ndarray:
+            return np.load(os.path.join(path, f'{name}.npy'), mmap_mode=('c' if mmap else None))
+
+        def load_strings(name: str) -> Optional[pd.Series]:
+            if labels[f'{name}_index'] is None:
+                return None
+            return _utf8_decode(load_array(f'{name}_utf8'), load_array(f'{name}_offsets'),
+                                labels[f'{name}_index'], labels[f'{name}_name'],
+                                arrow=mmap or not state['object_strings'][name])
+
+        duplicates = load_strings('duplicates')
+        string_grouper = StringGrouper(load_strings('master'), duplicates,
+                                       labels['master_id'], labels['duplicates_id'],
+                                       labels['block_by'], labels['duplicates_block_by'],
+                                       **state['config'])
+
+        def load_matrix(name: str) -> csr_matrix:
+            indptr = load_array(f'{name}_indptr')
+            return csr_matrix((load_array(f'{name}_data'), load_array(f'{name}_indices'), indptr),
+                              shape=(len(indptr) - 1, len(idf)), copy=False)
+
+        idf = load_array('idf')
+        if not string_grouper._config.feature_hashing:
+            string_grouper._vectorizer.vocabulary_ = _NGramVocabulary(load_array('vocabulary'))
+        string_grouper._vectorizer.idf_ = idf
+        string_grouper._master_matrix = load_matrix('master_matrix')
+        string_grouper._duplicate_matrix = string_grouper._master_matrix if duplicates is None \
+            else load_matrix('duplicate_matrix')
+        string_grouper._document_frequency = load_array('document_frequency')
+        string_grouper._n_documents = state['n_documents']
+        string_grouper._nearest_only = state['nearest_only']
+        string_grouper._matches_list = pd.DataFrame({column: load_array(f'matches_{column}')
+                                                     for column in ('master_side', 'dupe_side', 'similarity')},
+                                                    copy=False)
+        string_grouper.is_build = True
+        return string_grouper
+
     def dot(self) -> pd.Series:
         """Computes the row-wise similarity scores between strings in _master and _duplicates"""
         if len(self._master) != len(self._duplicates):
@@ -284,6 +1659,72 @@ class StringGrouper(object):
         :param suppress_warning: when min_similarity <=0 and include_zeroes=True, determines whether or not to suppress
         the message warning that max_n_matches may be too small.  Defaults to self._config.suppress_warning.
         """
+        if ignore_index is None: ignore_index = self._config.ignore_index
+        if include_zeroes is None: include_zeroes = self._config.include_zeroes
+        if suppress_warning is None: suppress_warning = self._config.suppress_warning
+        with self._stage('get_matches'):
+            if self._config.min_similarity > 0 or not include_zeroes:
+                matches_list = self._matches_list
+            elif include_zeroes:
+                # Here's a fix to a bug pointed out by one GitHub user (@nbcvijanovic):
+                # the fix includes zero-similarity matches that are missing by default 
+                # in _matches_list due to our use of sparse matrices 
+                with self._stage('get_non_matches_list') as stage:
+                    non_matches_list = self._get_non_matches_list(suppress_warning)
+                    stage['rows'] = len(non_matches_list)
+                matches_list = self._matches_list if non_matches_list.empty else \
+                    pd.concat([self._matches_list, non_matches_list], axis=0, ignore_index=True)
+            with self._stage('get_matches_output') as stage:
+                output = self._get_matches_output(matches_list, ignore_index)
+                stage['rows'] = len(output)
+        return output
+
+    @validate_is_fit
+    def iter_matches(self,
+                     chunksize: int = DEFAULT_CHUNKSIZE,
+                     ignore_index: Optional[bool] = None,
+                     include_zeroes: Optional[bool] = None,
+                     suppress_warning: Optional[bool] = None) -> Iterator[pd.DataFrame]:
+        """
+        Returns an iterator over the rows of get_matches in consecutive DataFrames (chunks) of at most chunksize
+        rows each, which, concatenated, equal the output of get_matches.  Zero-similarity matches (see
+        include_zeroes) are generated block by block from the complement of the matches, so that all pairs of strings
+        are never held in memory at once and each chunk can, for instance, be written to disk before the next one
+        is generated.
+
+        :param chunksize: int.  The maximum number of rows of each chunk.  Default is 100000.
+        :param ignore_index: whether or not to exclude string Series index-columns in output.  Defaults to
+        self._config.ignore_index.
+        :param include_zeroes: when the minimum cosine similarity <=0, determines whether zero-similarity matches
+        appear in the output.  Defaults to self._config.include_zeroes.
+        :param suppress_warning: when min_similarity <=0 and include_zeroes=True, determines whether or not to suppress
+        the message warning that max_n_matches may be too small.  Defaults to self._config.suppress_warning.
+        """
+        if not chunksize >= 1:
+            raise Exception("Invalid value for chunksize. It must be a positive integer.")
+        if ignore_index is None: ignore_index = self._config.ignore_index
+        if include_zeroes is None: include_zeroes = self._config.include_zeroes
+        if suppress_warning is None: suppress_warning = self._config.suppress_warning
+        blocks = [self._matches_list]
+        if self._config.min_similarity <= 0 and include_zeroes:
+            blocks = itertools.chain(blocks, self._iter_non_matches_blocks(chunksize, suppress_warning))
+        return self._iter_matches_output(blocks, chunksize, ignore_index)
+
+    def _iter_matches_output(self,
+                             blocks: Iterable[pd.DataFrame],
+                             chunksize: int,
+                             ignore_index: bool) -> Iterator[pd.DataFrame]:
+        """Generates the output of get_matches for the matches in blocks, in chunks of at most chunksize rows"""
+        offset = 0
+        for block in blocks:
+            for start in range(0, len(block), chunksize):
+                chunk = self._get_matches_output(block.iloc[start:start + chunksize], ignore_index)
+                chunk.index = pd.RangeIndex(offset, offset + len(chunk))
+                offset += len(chunk)
+                yield chunk
+
+    def _get_matches_output(self, matches_list: pd.DataFrame, ignore_index: bool) -> pd.DataFrame:
+        """Returns the output of get_matches for the matches in matches_list"""
         def get_both_sides(master: pd.Series,
                            duplicates: pd.Series,
                            generic_name=(DEFAULT_COLUMN_NAME, DEFAULT_COLUMN_NAME),
@@ -304,19 +1745,6 @@ class StringGrouper(object):
             else:
                 return data.rename(f"{prefix}{data.name}")
 
-        if ignore_index is None: ignore_index = self._config.ignore_index
-        if include_zeroes is None: include_zeroes = self._config.include_zeroes
-        if suppress_warning is None: suppress_warning = self._config.suppress_warning
-        if self._config.min_similarity > 0 or not include_zeroes:
-            matches_list = self._matches_list
-        elif include_zeroes:
-            # Here's a fix to a bug pointed out by one GitHub user (@nbcvijanovic):
-            # the fix includes zero-similarity matches that are missing by default 
-            # in _matches_list due to our use of sparse matrices 
-            non_matches_list = self._get_non_matches_list(suppress_warning)
-            matches_list = self._matches_list if non_matches_list.empty else \
-                pd.concat([self._matches_list, non_matches_list], axis=0, ignore_index=True)
-            
         left_side, right_side = get_both_sides(self._master, self._duplicates, drop_index=ignore_index)
         similarity = matches_list.similarity.reset_index(drop=True)
         if self._master_id is None:
@@ -364,66 +1792,403 @@ class StringGrouper(object):
         corresponding duplicates-index values. Defaults to self._config.replace_na.
          """
         if ignore_index is None: ignore_index = self._config.ignore_index
-        if self._duplicates is None:
-            return self._deduplicate(ignore_index=ignore_index)
-        else:
-            if replace_na is None: replace_na = self._config.replace_na
-            return self._get_nearest_matches(ignore_index=ignore_index, replace_na=replace_na)
+        if replace_na is None: replace_na = self._config.replace_na
+        with self._stage('get_groups'):
+            if self._duplicates is None:
+                with self._stage('deduplicate') as stage:
+                    stage['rows'] = len(self._matches_list)
+                    return self._deduplicate(ignore_index=ignore_index)
+            else:
+                with self._stage('get_nearest_matches') as stage:
+                    stage['rows'] = len(self._matches_list)
+                    return self._get_nearest_matches(ignore_index=ignore_index, replace_na=replace_na)
+
+    @validate_is_fit
+    def query(self, string: str, k: int = 1, min_similarity: Optional[float] = None) -> pd.DataFrame:
+        """
+        Returns the (at most) k master strings most similar to string, by decreasing similarity, with their IDs (if
+        given) and similarities, indexed like master.  Unlike match_most_similar, nothing is refit: string is
+        vectorized with the fitted vocabulary and IDF, and looked up in an inverted index of the n-grams of master
+        (built on first use) with MaxScore, which only scores exactly the few master strings that can still make the
+        top k once the postings of the rarer n-grams of string are accumulated.
+
+        :param string: str.  The string to look up.
+        :param k: int.  The largest number of master strings to return.  Defaults to 1.
+        :param min_similarity: float.  Only master strings more similar than this are returned.  Defaults to the
+        min_similarity of this StringGrouper.
+        """
+        if k < 1:
+            raise ValueError('k must be a positive integer.')
+        min_similarity = self._config.min_similarity if min_similarity is None else min_similarity
+        if self._query_index is None:
+            self._query_index = _QueryIndex(self._master_matrix)
+            self._query_master = self._master if self._master.name else self._master.rename(DEFAULT_MASTER_NAME)
+            if self._master_id is not None:
+                self._query_master_id = self._master_id if self._master_id.name \
+                    else self._master_id.rename(DEFAULT_MASTER_ID_NAME)
+        query_vector = self._vectorizer.transform(pd.Series([string]))
+        query_vector.sort_indices()
+        positions, similarities = self._query_index.search(query_vector, k, min_similarity)
+        columns = [self._query_master.iloc[positions]]
+        if self._master_id is not None:
+            master_id = self._query_master_id
+            columns.append(pd.Series(master_id.to_numpy()[positions], index=columns[0].index, name=master_id.name))
+        columns.append(pd.Series(similarities, index=columns[0].index, name='similarity'))
+        return pd.concat(columns, axis=1)
 
     @validate_is_fit
     def add_match(self, master_side: str, dupe_side: str) -> 'StringGrouper':
         """Adds a match if it wasn't found by the fit function"""
-        master_indices, dupe_indices = self._get_indices_of(master_side, dupe_side)
+        return self.add_matches([(master_side, dupe_side)])
 
-        # add prior matches to new match
-        prior_matches = self._matches_list.master_side[self._matches_list.dupe_side.isin(dupe_indices)]
-        dupe_indices = dupe_indices.append(prior_matches)
-        dupe_indices.drop_duplicates(inplace=True)
+    @validate_is_fit
+    def remove_match(self, master_side: str, dupe_side: str) -> 'StringGrouper':
+        """ Removes a match from the StringGrouper"""
+        return self.remove_matches([(master_side, dupe_side)])
 
-        similarities = [1]
+    @validate_is_fit
+    def add_matches(self, pairs: Union[pd.DataFrame, Iterable[Tuple[str, str]]]) -> 'StringGrouper':
+        """
+        Adds the matches of many pairs of strings at once, in one pass over the list of matches.  Each pair is added
+        as add_match would add it to the matches as they were before this call: every occurrence of its master side
+        is matched (with similarity 1) with every occurrence of its dupe side and, if only master was given, with
+        every string already matched with its dupe side (and symmetrically).
 
-        # cross join the indices
-        new_matches = StringGrouper._cross_join(dupe_indices, master_indices, similarities)
+        :param pairs: pandas.DataFrame (whose first two columns are the master and dupe sides) or iterable of
+        (master_side, dupe_side) tuples of strings.
+        """
+        master_positions, master_pair, dupe_positions, dupe_pair = self._get_pair_positions(pairs)
+        if len(master_pair) == 0:
+            return self
+        old_matches = self._matches_list.drop_duplicates()
+        if self._duplicates is None:
+            # add prior matches to new matches:
+            old_master_side = old_matches.master_side.to_numpy(dtype=np.int64)
+            old_dupe_side = old_matches.dupe_side.to_numpy(dtype=np.int64)
+            by_dupe = np.argsort(old_dupe_side, kind='stable')
+            first, last = (np.searchsorted(old_dupe_side[by_dupe], dupe_positions, side=side)
+                           for side in ('left', 'right'))
+            prior = old_master_side[by_dupe][_concatenated_ranges(first, last - first)]
+            dupe_positions = np.concatenate([dupe_positions, prior])
+            dupe_pair = np.concatenate([dupe_pair, np.repeat(dupe_pair, last - first)])
+            # (each string once per pair, in order of first appearance)
+            _, first_appearance = np.unique(dupe_pair * len(self._master) + dupe_positions, return_index=True)
+            first_appearance.sort()
+            dupe_positions, dupe_pair = dupe_positions[first_appearance], dupe_pair[first_appearance]
+        # cross join the occurrences of the two sides of each pair:
+        n_pairs = master_pair[-1] + 1
+        rows, cols, _ = _cross_join_groups(np.arange(n_pairs), np.arange(n_pairs), master_pair, dupe_pair)
+        new_matches = pd.DataFrame({'master_side': master_positions[rows],
+                                    'dupe_side': dupe_positions[cols],
+                                    'similarity': np.ones(len(rows), dtype=old_matches.similarity.dtype)})
         # If we are de-duping within one Series, we need to make sure the matches stay symmetric
         if self._duplicates is None:
+            if self._disjoint_set is not None:
+                # (the transposed matches unite the same sets)
+                self._disjoint_set.union_many(master_positions[rows], dupe_positions[cols])
             new_matches = StringGrouper._make_symmetric(new_matches)
         # update the matches
-        self._matches_list = pd.concat([self._matches_list.drop_duplicates(), new_matches], ignore_index=True)
-
+        self._matches_list = pd.concat([old_matches, new_matches.drop_duplicates()], ignore_index=True)
         return self
 
     @validate_is_fit
-    def remove_match(self, master_side: str, dupe_side: str) -> 'StringGrouper':
-        """ Removes a match from the StringGrouper"""
-        master_indices, dupe_indices = self._get_indices_of(master_side, dupe_side)
+    def remove_matches(self, pairs: Union[pd.DataFrame, Iterable[Tuple[str, str]]]) -> 'StringGrouper':
+        """
+        Removes the matches of many pairs of strings at once, in one pass over the list of matches: the matches of
+        every occurrence of the master side of each pair with every occurrence of its dupe side (and, if only master
+        was given, the other way around, as remove_match does).
+
+        :param pairs: pandas.DataFrame (whose first two columns are the master and dupe sides) or iterable of
+        (master_side, dupe_side) tuples of strings.
+        """
+        master_positions, master_pair, dupe_positions, dupe_pair = self._get_pair_positions(pairs)
+        if len(master_pair) == 0:
+            return self
         # In the case of having only a master series, we need to remove both the master - dupe match
         # and the dupe - master match:
         if self._duplicates is None:
-            master_indices = pd.concat([master_indices, dupe_indices])
-            dupe_indices = master_indices
-
-        self._matches_list = self._matches_list[
-            ~(
-                    (self._matches_list.master_side.isin(master_indices)) &
-                    (self._matches_list.dupe_side.isin(dupe_indices))
-            )]
+            master_positions = dupe_positions = np.concatenate([master_positions, dupe_positions])
+            master_pair = dupe_pair = np.concatenate([master_pair, dupe_pair])
+        n_pairs = master_pair.max() + 1
+        rows, cols, _ = _cross_join_groups(np.arange(n_pairs), np.arange(n_pairs), master_pair, dupe_pair)
+        n_dupes = len(self._master if self._duplicates is None else self._duplicates)
+        removed = master_positions[rows] * n_dupes + dupe_positions[cols]
+        is_removed = np.isin(self._matches_list.master_side.to_numpy(dtype=np.int64) * n_dupes +
+                             self._matches_list.dupe_side.to_numpy(dtype=np.int64),
+                             removed)
+        if self._disjoint_set is not None and is_removed.any():
+            # the groups of these strings may have split; this is checked the next time the groups are needed:
+            self._split_suspects.update(master_positions.tolist())
+        self._matches_list = self._matches_list[~is_removed]
         return self
 
+    def _get_pair_positions(self, pairs) -> Tuple[np.ndarray, np.ndarray, np.ndarray, np.ndarray]:
+        """
+        Returns the positions of all occurrences of the master sides of pairs (of strings) in master together with
+        the number of the pair of each, and the same for the dupe sides in duplicates (or master).  Strings are
+        looked up in hash indices of master and duplicates, which are built on first use.
+        """
+        if not isinstance(pairs, pd.DataFrame):
+            pairs = pd.DataFrame(list(pairs), columns=['master_side', 'dupe_side'])
+        if self._string_indices is None:
+            master_index = _StringIndex(self._master)
+            self._string_indices = (master_index,
+                                    master_index if self._duplicates is None else _StringIndex(self._duplicates))
+        master_index, dupe_index = self._string_indices
+        # Check if input is valid:
+        master_positions, master_pair = master_index.positions_of(
+            pairs.iloc[:, 0], lambda missing: ValueError(f'{missing} not found in StringGrouper string series')
+        )
+        dupe_positions, dupe_pair = dupe_index.positions_of(
+            pairs.iloc[:, 1], lambda missing: ValueError(f'{missing} not found in StringGrouper dupe string series')
+        )
+        return master_positions, master_pair, dupe_positions, dupe_pair
+
     def _get_tf_idf_matrices(self) -> Tuple[csr_matrix, csr_matrix]:
+        if self._config.feature_hashing:
+            # Hashed n-grams need no vocabulary, so each Series is tokenized only once and never concatenated:
+            strings = [self._master] if self._duplicates is None else [self._master, self._duplicates]
+            with self._stage('fit_transform') as stage:
+                matrices = self._vectorizer.fit_transform(*strings)
+                stage.update(shapes=[m.shape for m in matrices], nnz=[m.nnz for m in matrices])
+            return matrices[0], matrices[-1]
         # Fit the tf-idf vectorizer
-        self._vectorizer = self._fit_vectorizer()
+        with self._stage('fit_vectorizer') as stage:
+            self._vectorizer = self._fit_vectorizer()
+            stage['n_features'] = len(self._vectorizer.vocabulary_)
         # Build the two matrices
-        master_matrix = self._vectorizer.transform(self._master)
+        with self._stage('transform') as stage:
+            master_matrix = self._vectorizer.transform(self._master)
 
-        if self._duplicates is not None:
-            duplicate_matrix = self._vectorizer.transform(self._duplicates)
-        # IF there is no duplicate matrix, we assume we want to match on the master matrix itself
-        else:
-            duplicate_matrix = master_matrix
+            if self._duplicates is not None:
+                duplicate_matrix = self._vectorizer.transform(self._duplicates)
+            # IF there is no duplicate matrix, we assume we want to match on the master matrix itself
+            else:
+                duplicate_matrix = master_matrix
+            matrices = [master_matrix] if self._duplicates is None else [master_matrix, duplicate_matrix]
+            stage.update(shapes=[m.shape for m in matrices], nnz=[m.nnz for m in matrices])
 
         return master_matrix, duplicate_matrix
 
-    def _fit_vectorizer(self) -> TfidfVectorizer:
+    def _get_collapsed_tf_idf_matrices(self) -> Tuple[csr_matrix, csr_matrix, np.ndarray, np.ndarray]:
+        """
+        Returns the TF-IDF matrices of the unique strings of master and duplicates (strings are equal if they are
+        after ignoring case and removing regex matches, as in n_grams, and have equal blocking keys), and the
+        inverses mapping each string to the row of its unique string.  Without duplicates, the matrix and inverse of
+        master are returned twice.
+
+        Only the unique strings are vectorized, but the IDF is computed from the document frequencies of all strings
+        (each unique string counting as many times as it occurs), so the row of each string is the same as if all
+        strings had been vectorized.
+        """
+        series = [self._master] if self._duplicates is None else [self._master, self._duplicates]
+        block_codes = self._get_block_codes()[:len(series)]
+        with self._stage('collapse') as stage:
+            uniques, inverses = [], []
+            for strings, codes in zip(series, block_codes):
+                # (as python strings, since the str methods of Arrow-backed strings lowercase and apply regexes
+                # differently from n_grams)
+                normalized = strings.astype(object)
+                normalized = normalized.str.lower() if self._config.ignore_case else normalized
+                normalized = normalized.str.replace(self._config.regex, '', regex=True)
+                keys, _ = pd.factorize(normalized)
+                keys = keys.astype(np.int64)
+                if codes is not None:
+                    keys = keys * (codes.max() + 2) + (codes + 1)
+                _, first, inverse = np.unique(keys, return_index=True, return_inverse=True)
+                uniques.append(strings.iloc[first])
+                inverses.append(inverse.ravel())
+            stage['unique'] = [len(u) for u in uniques]
+        with self._stage('fit_transform') as stage:
+            if self._config.feature_hashing:
+                matrices = self._vectorizer.fit_transform(*uniques)
+            else:
+                self._vectorizer.fit(pd.concat(uniques))
+                matrices = [self._vectorizer.transform(u) for u in uniques]
+            # reweigh the TF-IDF matrices with the IDF of all strings (the l2-normalization absorbs the old IDF):
+            multiplicities = [np.bincount(inverse) for inverse in inverses]
+            document_frequency = sum(np.bincount(m.indices, weights=np.repeat(w, np.diff(m.indptr)),
+                                                 minlength=m.shape[1])
+                                     for m, w in zip(matrices, multiplicities))
+            idf = np.log((1 + sum(len(s) for s in series)) / (1 + document_frequency)) + 1
+            scale = idf / np.asarray(self._vectorizer.idf_)
+            self._vectorizer.idf_ = idf
+            for m in matrices:
+                m.data *= scale[m.indices]
+            matrices = [normalize(m, norm='l2', copy=False) for m in matrices]
+            stage.update(shapes=[m.shape for m in matrices], nnz=[m.nnz for m in matrices])
+        return matrices[0], matrices[-1], inverses[0], inverses[-1]
+
+    def _expand_collapsed_matrices(self,
+                                   unique_master_matrix: csr_matrix,
+                                   unique_duplicate_matrix: csr_matrix,
+                                   master_inverse: np.ndarray,
+                                   dupe_inverse: np.ndarray) -> Tuple[csr_matrix, csr_matrix]:
+        """Returns the TF-IDF matrices of all strings, copied from those of the unique strings"""
+        master_matrix = unique_master_matrix[master_inverse]
+        if self._duplicates is None:
+            return master_matrix, master_matrix
+        return master_matrix, unique_duplicate_matrix[dupe_inverse]
+
+    def _build_collapsed_matches(self,
+                                 unique_master_matrix: csr_matrix,
+                                 unique_duplicate_matrix: csr_matrix,
+                                 master_inverse: np.ndarray,
+                                 dupe_inverse: np.ndarray) -> csr_matrix:
+        """
+        Builds the same top-n cosine similarity matrix as _build_matches of the matrices of all strings, from the
+        matches of the unique strings only.  All copies of a unique master string have the same best matches, so
+        these are built once per unique master string: each of its unique matches is expanded into (at most
+        max_n_matches of) the first copies of its unique duplicate, which is enough since only max_n_matches are
+        kept, and the best max_n_matches among those are then copied to every copy of the master string.  So the
+        work and memory grow linearly with the number of copies.
+        """
+        is_self_join = self._duplicates is None
+        unique_duplicate_matrix = unique_master_matrix if is_self_join else unique_duplicate_matrix
+        master_codes, dupe_codes = self._get_block_codes()
+        if master_codes is not None:
+            # (all copies of a unique string have the same blocking key)
+            master_codes = master_codes[np.unique(master_inverse, return_index=True)[1]]
+            dupe_codes = master_codes if is_self_join else dupe_codes[np.unique(dupe_inverse, return_index=True)[1]]
+        unique_matches = self._build_matches_within_blocks(unique_master_matrix, unique_duplicate_matrix,
+                                                           master_codes, dupe_codes, self._build_matches)
+        unique_rows, unique_cols, unique_values = _csr_to_triplets(unique_matches)
+        ntop = self._config.max_n_matches
+        # the best matches of each unique master string among the first copies of its unique matches:
+        col_members = np.argsort(dupe_inverse, kind='stable')
+        col_count = np.bincount(dupe_inverse).astype(np.int64)
+        col_start = np.cumsum(col_count) - col_count
+        n_copies = np.minimum(col_count[unique_cols], ntop)
+        pair = np.repeat(np.arange(len(unique_cols)), n_copies)
+        top_rows, top_cols, top_values = _top_n_per_row(unique_rows[pair],
+                                                        col_members[_concatenated_ranges(col_start[unique_cols],
+                                                                                         n_copies)],
+                                                        unique_values[pair], ntop)
+        # copied to every copy of the unique master string:
+        top_count = np.bincount(top_rows, minlength=unique_master_matrix.shape[0]).astype(np.int64)
+        top_start = np.cumsum(top_count) - top_count
+        row_count = top_count[master_inverse]
+        entries = _concatenated_ranges(top_start[master_inverse], row_count)
+        indptr = np.append(0, np.cumsum(row_count))
+        return csr_matrix((top_values[entries], top_cols[entries], indptr),
+                          shape=(len(master_inverse), len(dupe_inverse)))
+
+    def _build_collapsed_nearest_matches_list(self,
+                                              unique_master_matrix: csr_matrix,
+                                              unique_duplicate_matrix: csr_matrix,
+                                              master_inverse: np.ndarray,
+                                              dupe_inverse: np.ndarray) -> pd.DataFrame:
+        """
+        Builds the same list as _build_nearest_matches_list of the matrices of all strings, from the most similar
+        unique master string of each unique duplicate: every copy of the duplicate is matched with the first copy of
+        that master string.  (Without block_by the unique strings are numbered in order of first appearance, so ties
+        still go to the first master string.)
+        """
+        unique_nearest = self._build_nearest_matches_list(unique_master_matrix, unique_duplicate_matrix)
+        first_master_copy = np.unique(master_inverse, return_index=True)[1]
+        nearest = np.full(unique_duplicate_matrix.shape[0], -1, dtype=np.int64)
+        nearest[unique_nearest.dupe_side.to_numpy()] = first_master_copy[unique_nearest.master_side.to_numpy()]
+        similarity = np.zeros(unique_duplicate_matrix.shape[0], dtype=unique_nearest.similarity.dtype)
+        similarity[unique_nearest.dupe_side.to_numpy()] = unique_nearest.similarity.to_numpy()
+        dupe_side = np.flatnonzero(nearest[dupe_inverse] >= 0)
+        master_side = nearest[dupe_inverse[dupe_side]]
+        order = np.lexsort((dupe_side, master_side))
+        return pd.DataFrame({'master_side': master_side[order],
+                             'dupe_side': dupe_side[order],
+                             'similarity': similarity[dupe_inverse[dupe_side]][order]},
+                            copy=False)
+
+    @contextmanager
+    def _stage(self, name: str):
+        """
+        Context of a stage of fit, get_matches or get_groups.  If collect_stats=True, records its wall time, CPU
+        time and increase of the peak resident set size (of the whole process) into stats, together with what the
+        stage put into the yielded dict (e.g. shapes and numbers of nonzeros of its matrices).  While tracemalloc is
+        tracing (on Python >= 3.9), the peak memory traced during the stage is recorded too.  Otherwise does
+        nothing.
+        """
+        record = dict()
+        if not self._config.collect_stats:
+            yield record
+            return
+        record.update(call=self._open_stages[0] if self._open_stages else name, stage=name)
+        self._open_stages.append(name)
+        is_tracing = tracemalloc.is_tracing() and hasattr(tracemalloc, 'reset_peak')
+        if is_tracing:
+            # the traced peak is reset for each stage, so the peak of the enclosing stage so far is set aside:
+            if self._traced_peaks:
+                self._traced_peaks[-1] = max(self._traced_peaks[-1], tracemalloc.get_traced_memory()[1])
+            self._traced_peaks.append(0)
+            tracemalloc.reset_peak()
+        max_rss, wall, cpu = _max_rss_mb(), time.perf_counter(), time.process_time()
+        try:
+            yield record
+        finally:
+            self._open_stages.pop()
+            traced_peak = max(self._traced_peaks.pop(), tracemalloc.get_traced_memory()[1]) if is_tracing else None
+        record.update(wall_s=time.perf_counter() - wall,
+                      cpu_s=time.process_time() - cpu,
+                      peak_rss_delta_mb=None if max_rss is None else _max_rss_mb() - max_rss)
+        if traced_peak is not None:
+            record['peak_traced_mb'] = traced_peak / 2**20
+        self.stats.append(record)
+
+    def _get_vocabulary_array(self) -> np.ndarray:
+        """Returns the n-grams of the fitted vocabulary in column order as a fixed-width unicode array"""
+        vocabulary = self._vectorizer.vocabulary_
+        if isinstance(vocabulary, _NGramVocabulary):
+            return vocabulary.n_grams
+        n_grams = np.empty(len(vocabulary), dtype=f'U{self._config.ngram_size}')
+        n_grams[np.fromiter(vocabulary.values(), dtype=np.int64, count=len(vocabulary))] = list(vocabulary.keys())
+        return n_grams
+
+    def _get_document_frequency(self) -> np.ndarray:
+        """Returns the number of fitted strings that contain each n-gram"""
+        matrices = [self._master_matrix] if self._duplicates is None else [self._master_matrix, self._duplicate_matrix]
+        return sum(np.bincount(m.indices, minlength=m.shape[1]) for m in matrices)
+
+    def _idf_drift(self) -> float:
+        """
+        Returns the largest relative change of the (smoothed) IDF of any fitted n-gram that refitting on the fitted
+        strings and the strings added by update would cause
+        """
+        fitted_idf = self._vectorizer.idf_
+        idf = np.log((1 + self._n_documents) / (1 + self._document_frequency)) + 1
+        return float(np.max(np.abs(idf - fitted_idf) / fitted_idf, initial=0))
+
+    def _get_updated_self_join_matches_list(self, new_matrix: csr_matrix, n_old: int) -> pd.DataFrame:
+        """Merges the (symmetrized) matches of the n_old + 1st and later strings of master into _matches_list"""
+        n = self._master_matrix.shape[0]
+        master_codes, _ = self._get_block_codes()
+        new_codes = None if master_codes is None else master_codes[n_old:]
+        rows, cols, values = _csr_to_triplets(self._build_matches_within_blocks(
+            new_matrix, self._master_matrix, new_codes, master_codes, self._build_matches
+        ))
+        new_matches = csr_matrix((values, (rows + n_old, cols)), shape=(n, n))
+        new_matches_list = self._get_matches_list(self._symmetrize_matches(new_matches))
+        matches_list = pd.concat([self._matches_list, new_matches_list], ignore_index=True)
+        return matches_list.sort_values(['master_side', 'dupe_side']).reset_index(drop=True)
+
+    def _get_updated_matches_list(self, new_matrix: csr_matrix, n_old: int) -> pd.DataFrame:
+        """Merges the matches of the n_old + 1st and later strings of duplicates into _matches_list"""
+        master_codes, dupe_codes = self._get_block_codes()
+        new_codes = None if dupe_codes is None else dupe_codes[n_old:]
+        rows, cols, values = _csr_to_triplets(self._build_matches_within_blocks(
+            self._master_matrix, new_matrix, master_codes, new_codes, self._build_matches
+        ))
+        old = self._matches_list
+        master_side, dupe_side, similarity = _top_n_per_row(
+            np.concatenate([old.master_side.to_numpy(dtype=np.int64), rows]),
+            np.concatenate([old.dupe_side.to_numpy(dtype=np.int64), cols + n_old]),
+            np.concatenate([old.similarity.to_numpy(), values]),
+            self._config.max_n_matches
+        )
+        return pd.DataFrame({'master_side': master_side,
+                             'dupe_side': dupe_side,
+                             'similarity': similarity},
+                            copy=False)
+
+    def _fit_vectorizer(self) -> NGramTfidfVectorizer:
         # if both dupes and master string series are set - we concat them to fit the vectorizer on all
         # strings
         if self._duplicates is not None:
@@ -433,16 +2198,100 @@ class StringGrouper(object):
         self._vectorizer.fit(strings)
         return self._vectorizer
 
-    def _build_matches(self, master_matrix: csr_matrix, duplicate_matrix: csr_matrix) -> csr_matrix:
-        """Builds the cossine similarity matrix of two csr matrices"""
+    def _get_block_codes(self) -> Tuple[Optional[np.ndarray], Optional[np.ndarray]]:
+        """
+        Returns the blocking keys of master and duplicates as integer codes (equal keys get equal codes on both
+        sides, missing keys form a block of their own), or (None, None) if block_by was not given.  Without
+        duplicates, the codes of master are returned twice.
+        """
+        if self._block_by is None:
+            return None, None
+        keys = [self._block_by] if self._duplicates is None else [self._block_by, self._duplicates_block_by]
+        codes, _ = pd.factorize(pd.concat(keys, ignore_index=True))
+        codes = codes.astype(np.int64)
+        n_master = len(self._block_by)
+        return codes[:n_master], (codes[:n_master] if self._duplicates is None else codes[n_master:])
+
+    def _build_matches_within_blocks(self,
+                                     master_matrix: csr_matrix,
+                                     duplicate_matrix: csr_matrix,
+                                     master_codes: Optional[np.ndarray],
+                                     dupe_codes: Optional[np.ndarray],
+                                     build) -> csr_matrix:
+        """
+        Builds the cosine similarity matrix of two csr matrices with build(master_block, duplicates_block, n_jobs)
+        for each block of rows with equal codes on both sides only (so the result is block-diagonal up to the order
+        of its rows and columns).  The blocks are built concurrently on number_of_processes threads, the largest
+        blocks first, and each block with one thread.  Without codes, build is called once on the whole matrices.
+        """
+        if master_codes is None:
+            return build(master_matrix, duplicate_matrix)
+        n_master, n_dupes = master_matrix.shape[0], duplicate_matrix.shape[0]
+        is_self_join = duplicate_matrix is master_matrix and dupe_codes is master_codes
+        master_order = np.argsort(master_codes, kind='stable')
+        dupe_order = master_order if is_self_join else np.argsort(dupe_codes, kind='stable')
+        codes, master_start, master_count = np.unique(master_codes[master_order],
+                                                      return_index=True, return_counts=True)
+        sorted_dupe_codes = dupe_codes[dupe_order]
+        dupe_start = np.searchsorted(sorted_dupe_codes, codes, side='left')
+        dupe_count = np.searchsorted(sorted_dupe_codes, codes, side='right') - dupe_start
+        blocks = [(master_order[m0:m0 + m_n], dupe_order[d0:d0 + d_n])
+                  for m0, m_n, d0, d_n in zip(master_start, master_count, dupe_start, dupe_count) if d_n > 0]
+        blocks.sort(key=lambda block: -len(block[0]) * len(block[1]))
+
+        def build_block(master_rows: np.ndarray, dupe_rows: np.ndarray) -> Tuple[np.ndarray, ...]:
+            master_block = master_matrix[master_rows]
+            dupe_block = master_block if is_self_join else duplicate_matrix[dupe_rows]
+            rows, cols, values = _csr_to_triplets(build(master_block, dupe_block, n_jobs=1))
+            return master_rows[rows], dupe_rows[cols], values
+
+        with ThreadPoolExecutor(max_workers=max(1, self._config.number_of_processes)) as executor:
+            parts = list(executor.map(lambda block: build_block(*block), blocks))
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*parts)) if parts \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=master_matrix.dtype))
+        # (each master string lies in one block only, so no row has more than max_n_matches matches)
+        rows, cols, values = _top_n_per_row(rows, cols, values, self._config.max_n_matches)
+        indptr = np.append(0, np.cumsum(np.bincount(rows, minlength=n_master)))
+        return csr_matrix((values, cols, indptr), shape=(n_master, n_dupes))
+
+    def _build_matches(self,
+                       master_matrix: csr_matrix,
+                       duplicate_matrix: csr_matrix,
+                       n_jobs: Optional[int] = None) -> csr_matrix:
+        """
+        Builds the cossine similarity matrix of two csr matrices with the configured engine.  The symmetric engine
+        only applies to a matrix matched with itself (duplicate_matrix is master_matrix); other pairs of matrices are
+        matched with sparse_dot_topn, which finds the same matches.
+        """
+        if self._config.engine == ENGINE_SYMMETRIC and duplicate_matrix is master_matrix:
+            return self._build_symmetric_matches(master_matrix)
+        if self._config.engine == ENGINE_PRUNED and self._config.min_similarity > 0:
+            return self._build_pruned_matches(master_matrix, duplicate_matrix)
+        if self._config.engine == ENGINE_LSH:
+            return self._build_lsh_matches(master_matrix, duplicate_matrix)
+        if self._config.engine == ENGINE_BLOCKED:
+            return self._build_blocked_matches(master_matrix, duplicate_matrix, n_jobs)
+        return self._build_topn_matches(master_matrix, duplicate_matrix, n_jobs)
+
+    def _build_topn_matches(self,
+                            master_matrix: csr_matrix,
+                            duplicate_matrix: csr_matrix,
+                            n_jobs: Optional[int] = None) -> csr_matrix:
+        """
+        Builds the top-n cossine similarity matrix of two csr matrices with sparse_dot_topn, on n_jobs threads
+        (number_of_processes by default)
+        """
         tf_idf_matrix_1 = master_matrix
         tf_idf_matrix_2 = duplicate_matrix.transpose()
 
+        n_jobs = self._config.number_of_processes if n_jobs is None else n_jobs
+        if self._config.parallelism == PARALLELISM_PROCESSES and n_jobs > 1:
+            return self._build_topn_matches_in_processes(master_matrix, duplicate_matrix, n_jobs)
         optional_kwargs = dict()
-        if self._config.number_of_processes > 1:
+        if n_jobs > 1:
             optional_kwargs = {
                 'use_threads': True,
-                'n_jobs': self._config.number_of_processes
+                'n_jobs': n_jobs
             }
 
         return awesome_cossim_topn(tf_idf_matrix_1, tf_idf_matrix_2,
@@ -450,55 +2299,399 @@ class StringGrouper(object):
                                    self._config.min_similarity,
                                    **optional_kwargs)
 
-    def _symmetrize_matches_list(self):
-        # [symmetrized matches_list] = [matches_list] UNION [transposed matches_list] (i.e., column-names swapped):
-        self._matches_list = self._matches_list.set_index(['master_side', 'dupe_side'])\
-            .combine_first(
-                self._matches_list.rename(
-                    columns={
-                        'master_side': 'dupe_side',
-                        'dupe_side': 'master_side'
-                    }
-                ).set_index(['master_side', 'dupe_side'])
-            ).reset_index()
+    def _build_topn_matches_in_processes(self,
+                                         master_matrix: csr_matrix,
+                                         duplicate_matrix: csr_matrix,
+                                         n_processes: int) -> csr_matrix:
+        """
+        Builds the same top-n cosine similarity matrix as _build_topn_matches on a pool of n_processes worker
+        processes.  The master matrix and the transposed duplicates matrix are copied once into shared memory (so
+        they are never pickled), each worker computes the top-n matches of a shard of master rows into a local edge
+        list, and the edge lists are merged into one csr matrix.
+        """
+        n_master = master_matrix.shape[0]
+        transposed = duplicate_matrix.transpose().tocsr()
+        memories = []
+        try:
+            specs = []
+            for matrix in (master_matrix, transposed):
+                shared = [_share_array(array) for array in (matrix.data, matrix.indices, matrix.indptr)]
+                memories.extend(memory for memory, _ in shared)
+                specs.append(tuple(spec for _, spec in shared))
+            shard_size = max(1, -(-n_master // (n_processes * SHARDS_PER_PROCESS)))
+            shards = _tiles(n_master, shard_size)
+            with ProcessPoolExecutor(max_workers=n_processes) as executor:
+                futures = [executor.submit(_shared_topn_shard, specs[0], master_matrix.shape, specs[1],
+                                           transposed.shape, start, stop, self._config.max_n_matches,
+                                           self._config.min_similarity)
+                           for start, stop in shards]
+                parts = [future.result() for future in futures]
+        finally:
+            for memory in memories:
+                memory.close()
+                memory.unlink()
+        # (the shards are consecutive, so their rows are in order)
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*parts)) if parts \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=master_matrix.dtype))
+        indptr = np.append(0, np.cumsum(np.bincount(rows, minlength=n_master)))
+        return csr_matrix((values, cols, indptr), shape=(n_master, duplicate_matrix.shape[0]))
+
+    def _build_nearest_matches_list(self,
+                                    master_matrix: csr_matrix,
+                                    duplicate_matrix: csr_matrix,
+                                    n_jobs: Optional[int] = None) -> pd.DataFrame:
+        """
+        Builds the list of the most similar master string of each duplicate (the first one in case of ties) whose
+        similarity exceeds min_similarity.  Blocks of duplicates are multiplied with blocks of master, and each
+        duplicate only keeps a running maximum and its master index instead of a list of top-n matches.  The blocks of
+        duplicates are computed on n_jobs threads (number_of_processes by default).
+        """
+        n_dupes = duplicate_matrix.shape[0]
+        n_jobs = self._config.number_of_processes if n_jobs is None else n_jobs
+        best_similarity = np.full(n_dupes, self._config.min_similarity, dtype=duplicate_matrix.dtype)
+        best_master_side = np.full(n_dupes, -1, dtype=np.int64)
+        transposed_master_blocks = [(start, master_matrix[start:stop].transpose().tocsr())
+                                    for start, stop in _tiles(master_matrix.shape[0], NEAREST_BLOCK_SIZE)]
+
+        def build_block(bounds: Tuple[int, int]):
+            # (each block of duplicates only writes to its own slices of best_similarity and best_master_side)
+            d_start, d_stop = bounds
+            block = duplicate_matrix[d_start:d_stop]
+            block_best_similarity = best_similarity[d_start:d_stop]
+            block_best_master_side = best_master_side[d_start:d_stop]
+            for m_start, transposed_master_block in transposed_master_blocks:
+                similarities = block.dot(transposed_master_block).tocsr()
+                argmax = _csr_row_argmax(similarities.indptr, similarities.indices, similarities.data)
+                row_max = similarities.max(axis=1).toarray().ravel()
+                # strictly larger, so that earlier master blocks win ties:
+                better = (argmax >= 0) & (row_max > block_best_similarity)
+                block_best_similarity[better] = row_max[better]
+                block_best_master_side[better] = argmax[better] + m_start
+
+        _map_concurrently(build_block, _tiles(n_dupes, NEAREST_BLOCK_SIZE), n_jobs)
+        dupe_side = np.flatnonzero(best_master_side >= 0)
+        master_side = best_master_side[dupe_side]
+        order = np.lexsort((dupe_side, master_side))
+        return pd.DataFrame({'master_side': master_side[order],
+                             'dupe_side': dupe_side[order],
+                             'similarity': best_similarity[dupe_side][order]},
+                            copy=False)
+
+    def _build_pruned_matches(self, master_matrix: csr_matrix, duplicate_matrix: csr_matrix) -> csr_matrix:
+        """
+        Builds the same top-n cosine similarity matrix as _build_topn_matches (for min_similarity > 0), but only
+        evaluates candidate pairs whose similarity may exceed min_similarity (all-pairs/L2AP-style prefix filtering).
+
+        The features are ordered by decreasing document frequency, and each duplicate y is split into a prefix of its
+        most frequent features and an indexed suffix, such that no master string x (of norm 1) can reach
+        min_similarity through the prefix alone: x·y_prefix <= min(Σ_j y_j max_weight_j, ||y_prefix||), where
+        max_weight_j is the largest weight of feature j in master.  So every pair that exceeds min_similarity shares
+        an indexed feature.  Blocks of master are multiplied with the indexed suffixes only, candidates whose partial
+        similarity plus the bound of their prefix cannot exceed min_similarity are dropped, and the prefix products
+        of the remaining candidates are added exactly.
+        """
+        n_master, n_dupes = master_matrix.shape[0], duplicate_matrix.shape[0]
+        ntop, threshold = self._config.max_n_matches, self._config.min_similarity
+        n_features = master_matrix.shape[1]
+        # order the features by decreasing document frequency, so that the prefixes hold the frequent features:
+        document_frequency = np.bincount(duplicate_matrix.indices, minlength=n_features)
+        new_column = np.empty(n_features, dtype=np.int64)
+        new_column[np.argsort(-document_frequency, kind='stable')] = np.arange(n_features)
+        master = _permute_columns(master_matrix, new_column)
+        dupes = master if duplicate_matrix is master_matrix else _permute_columns(duplicate_matrix, new_column)
+        max_weight = master.max(axis=0).toarray().ravel()
+
+        # split each duplicate into its prefix and its indexed suffix:
+        dupe_rows = np.repeat(np.arange(n_dupes, dtype=np.int64), np.diff(dupes.indptr))
+        bound = np.minimum(_segment_cumsum(dupes.data * max_weight[dupes.indices], dupes.indptr),
+                           np.sqrt(_segment_cumsum(dupes.data ** 2, dupes.indptr)))
+        # (the bounds grow along each row, so the indexed elements are the last ones of each row)
+        is_indexed = bound >= threshold - PRUNING_TOLERANCE
+        prefix_length = np.bincount(dupe_rows[~is_indexed], minlength=n_dupes)
+        prefix_bound = np.zeros(n_dupes)
+        has_prefix = prefix_length > 0
+        prefix_bound[has_prefix] = bound[dupes.indptr[:-1][has_prefix] + prefix_length[has_prefix] - 1]
+        parts = dict()
+        for name, mask in (('prefix', ~is_indexed), ('indexed', is_indexed)):
+            parts[name] = csr_matrix(
+                (dupes.data[mask], dupes.indices[mask],
+                 np.append(0, np.cumsum(np.bincount(dupe_rows[mask], minlength=n_dupes)))),
+                shape=dupes.shape
+            )
+        transposed_indexed = parts['indexed'].transpose().tocsr()
+
+        top_n = []
+        for start, stop in _tiles(n_master, PRUNED_BLOCK_SIZE):
+            block = master[start:stop]
+            candidates = (block @ transposed_indexed).tocoo()
+            rows, cols, partial = candidates.row.astype(np.int64), candidates.col.astype(np.int64), candidates.data
+            may_match = partial + prefix_bound[cols] > threshold - PRUNING_TOLERANCE
+            rows, cols, partial = rows[may_match], cols[may_match], partial[may_match]
+            values = (partial + _pair_dot_products(block, parts['prefix'], rows, cols)).astype(master.dtype)
+            is_match = values > threshold
+            top_n.append(_top_n_per_row(rows[is_match] + start, cols[is_match], values[is_match], ntop))
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*top_n)) if top_n \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=master.dtype))
+        # (the rows are sorted, and each row by decreasing similarity, as in the output of sparse_dot_topn)
+        indptr = np.append(0, np.cumsum(np.bincount(rows, minlength=n_master)))
+        return csr_matrix((values, cols, indptr), shape=(n_master, n_dupes))
+
+    def _build_blocked_matches(self,
+                               master_matrix: csr_matrix,
+                               duplicate_matrix: csr_matrix,
+                               n_jobs: Optional[int] = None) -> csr_matrix:
+        """
+        Builds the same top-n cosine similarity matrix as _build_topn_matches in tiles of ACCUMULATOR_ROWS master
+        strings by ACCUMULATOR_COLUMNS duplicates strings.  The sparse product accumulates each row of a tile in a
+        dense array as long as the tile is wide, so narrow tiles keep it in the L2 cache.  The similarities of each
+        tile are thresholded at once, and merged into the running top-n matches of its rows, so that no more than
+        2 * max_n_matches candidates per row are ever held.  The row blocks are computed on n_jobs threads
+        (number_of_processes by default), each with its own accumulators.
+        """
+        n_master, n_dupes = master_matrix.shape[0], duplicate_matrix.shape[0]
+        ntop, threshold = self._config.max_n_matches, self._config.min_similarity
+        n_jobs = self._config.number_of_processes if n_jobs is None else n_jobs
+        transposed_tiles = [(start, duplicate_matrix[start:stop].transpose().tocsr())
+                            for start, stop in _tiles(n_dupes, ACCUMULATOR_COLUMNS)]
+
+        def build_row_block(bounds: Tuple[int, int]) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+            start, stop = bounds
+            block = master_matrix[start:stop]
+            rows = cols = np.empty(0, dtype=np.int64)
+            values = np.empty(0, dtype=master_matrix.dtype)
+            for column_start, transposed_tile in transposed_tiles:
+                tile_rows, tile_cols, tile_values = _csr_to_triplets(block @ transposed_tile)
+                is_match = tile_values > threshold
+                rows, cols, values = _top_n_per_row(np.concatenate([rows, tile_rows[is_match]]),
+                                                     np.concatenate([cols, tile_cols[is_match] + column_start]),
+                                                     np.concatenate([values, tile_values[is_match]]),
+                                                     ntop)
+            return rows + start, cols, values
+
+        # (the row blocks are consecutive, so their rows are in order)
+        parts = _map_concurrently(build_row_block, _tiles(n_master, ACCUMULATOR_ROWS), n_jobs)
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*parts)) if parts \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=master_matrix.dtype))
+        indptr = np.append(0, np.cumsum(np.bincount(rows, minlength=n_master)))
+        return csr_matrix((values, cols, indptr), shape=(n_master, n_dupes))
+
+    def _build_lsh_matches(self, master_matrix: csr_matrix, duplicate_matrix: csr_matrix) -> csr_matrix:
+        """
+        Builds an approximation of the top-n cosine similarity matrix of _build_topn_matches: candidate pairs are
+        generated by banded locality-sensitive hashing of the MinHash signatures of the n-gram sets of the strings
+        (a pair is a candidate if its signatures agree on all lsh_rows values of at least one of lsh_bands bands), and
+        only the exact cosine similarities of the candidates are computed.  Pairs of strings with few n-grams in
+        common are unlikely to become candidates, so some matches may be missed (see lsh_recall).
+        """
+        n_master, n_dupes = master_matrix.shape[0], duplicate_matrix.shape[0]
+        ntop, threshold = self._config.max_n_matches, self._config.min_similarity
+        is_self_join = duplicate_matrix is master_matrix
+        if not master_matrix.has_sorted_indices:
+            master_matrix = master_matrix.sorted_indices()
+        bands, rows_per_band = self._config.lsh_bands, self._config.lsh_rows
+        random_state = np.random.RandomState(MINHASH_SEED)
+        a = random_state.randint(1, MINHASH_PRIME, size=(bands, rows_per_band), dtype=np.int64)
+        b = random_state.randint(0, MINHASH_PRIME, size=(bands, rows_per_band), dtype=np.int64)
+        nonempty_master = np.flatnonzero(np.diff(master_matrix.indptr) > 0)
+        nonempty_dupes = np.flatnonzero(np.diff(duplicate_matrix.indptr) > 0)
+        candidates = np.empty(0, dtype=np.int64)
+        for band in range(bands):
+            master_keys = _minhash_band_keys(master_matrix, a[band], b[band])
+            dupe_keys = master_keys if is_self_join else \
+                _minhash_band_keys(duplicate_matrix, a[band], b[band])
+            left, right = _bucket_pairs(master_keys, dupe_keys, self._config.lsh_max_bucket_size)
+            candidates = np.union1d(candidates, nonempty_master[left] * n_dupes + nonempty_dupes[right])
+        # (the candidates are sorted, so their rows are too)
+        rows, cols = candidates // n_dupes, candidates % n_dupes
+        top_n = []
+        for start, stop in _tiles(len(candidates), LSH_CANDIDATE_CHUNK_SIZE):
+            values = _pair_dot_products(master_matrix, duplicate_matrix, rows[start:stop], cols[start:stop])
+            values = values.astype(master_matrix.dtype)
+            is_match = values > threshold
+            top_n.append((rows[start:stop][is_match], cols[start:stop][is_match], values[is_match]))
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*top_n)) if top_n \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=master_matrix.dtype))
+        rows, cols, values = _top_n_per_row(rows, cols, values, ntop)
+        indptr = np.append(0, np.cumsum(np.bincount(rows, minlength=n_master)))
+        return csr_matrix((values, cols, indptr), shape=(n_master, n_dupes))
+
+    def _build_symmetric_matches(self, matrix: csr_matrix, n_jobs: Optional[int] = None) -> csr_matrix:
+        """
+        Builds the same top-n cosine similarity matrix as _build_matches(matrix, matrix), but computes each
+        similarity only once: the rows are split into blocks, and each block is only multiplied with itself and the
+        blocks after it (the blocked upper triangle).  The lower triangle follows by transposition.  The block rows
+        of the upper triangle are computed on n_jobs threads (number_of_processes by default).
+        """
+        n = matrix.shape[0]
+        ntop, lower_bound = self._config.max_n_matches, self._config.min_similarity
+        n_jobs = self._config.number_of_processes if n_jobs is None else n_jobs
+        blocks = _tiles(n, SELF_JOIN_BLOCK_SIZE)
+        block_starts = np.array([r0 for r0, _ in blocks], dtype=np.int64)
+        transposed_blocks = [matrix[r0:r1].transpose().tocsr() for r0, r1 in blocks]
+
+        def build_block_row(i: int) -> Tuple[Tuple[np.ndarray, np.ndarray, np.ndarray],
+                                             Tuple[np.ndarray, np.ndarray, np.ndarray]]:
+            # returns the top-n similarities that block i contributes to its own rows (upper triangle) and to the
+            # rows of the blocks after it (lower triangle, by transposition):
+            r0, r1 = blocks[i]
+            block = matrix[r0:r1]
+            upper, lower = _TopNCandidates(ntop, 2 * (r1 - r0) * ntop), _TopNCandidates(ntop, 2 * (n - r0) * ntop)
+            for j in range(i, len(blocks)):
+                rows, cols, values = _csr_to_triplets(block @ transposed_blocks[j])
+                rows, cols = rows + r0, cols + blocks[j][0]
+                keep = values > lower_bound
+                if i == j:
+                    keep &= cols >= rows
+                rows, cols, values = rows[keep], cols[keep], values[keep]
+                upper.add(rows, cols, values)
+                off_diagonal = cols > rows
+                lower.add(cols[off_diagonal], rows[off_diagonal], values[off_diagonal])
+            return upper.top_n(), lower.top_n()
+
+        # candidates[k] collects the similarities of the rows in block k found so far:
+        candidates = [_TopNCandidates(ntop, 2 * (r1 - r0) * ntop) for r0, r1 in blocks]
+        top_n = []
+        # (the block rows are consumed in order, so all similarities of the rows of block i are known once block row
+        # i is)
+        for i, (upper, lower) in enumerate(_imap_concurrently(build_block_row, list(range(len(blocks))), n_jobs)):
+            candidates[i].add(*upper)
+            # (the lower triangle triplets are sorted by row, so they split into consecutive runs per block)
+            rows, cols, values = lower
+            bounds = np.searchsorted(rows, np.append(block_starts[(i + 1):], n))
+            for j, start, stop in zip(range(i, len(blocks)), np.append(0, bounds[:-1]), bounds):
+                if stop > start:
+                    candidates[j].add(rows[start:stop], cols[start:stop], values[start:stop])
+            top_n.append(candidates[i].top_n())
+            candidates[i] = None
+        rows, cols, values = (np.concatenate(arrays) for arrays in zip(*top_n)) if top_n \
+            else (np.empty(0, dtype=np.int64), np.empty(0, dtype=np.int64), np.empty(0, dtype=matrix.dtype))
+        return csr_matrix((values, (rows, cols)), shape=(n, n))
+
+    def _build_matches_list_out_of_core(self,
+                                        master_matrix: csr_matrix,
+                                        duplicate_matrix: csr_matrix) -> pd.DataFrame:
+        """
+        Builds the same _matches_list as fit() does in memory, but one tile (of tile_size master strings by
+        tile_size duplicates strings) at a time:
+        1. the top-n similarities of each tile are computed by the configured engine and spilled to disk;
+        2. for each tile of master strings, the partial top-n of all its tiles are merged (one at a time) into the
+           overall top-n and appended to an on-disk edge list; when master is matched with itself, the top-n is
+           symmetrized first, tile by tile, with the help of its spilled transpose.
+        The returned _matches_list is read from the (memory-mapped) edge list.
+
+        Only the matches are kept out of memory: no more than the product of one tile and the top-n candidates of one
+        tile of master strings (2 * tile_size * max_n_matches) are held at once.  The TF-IDF matrices of master and
+        duplicates are held in memory in full, and get_matches and get_groups build their outputs in memory from the
+        edge list (get_groups with an in-memory copy of the matches between distinct strings).
+        """
+        spill_dir = tempfile.mkdtemp(prefix='string_grouper_', dir=self._config.spill_dir)
+        self._spill_dir_finalizer = weakref.finalize(self, shutil.rmtree, spill_dir, True)
+        ntop, tile_size = self._config.max_n_matches, self._config.tile_size
+        master_tiles = _tiles(master_matrix.shape[0], tile_size)
+        duplicate_tiles = _tiles(duplicate_matrix.shape[0], tile_size)
+        # 1. spill the top-n similarities of each tile:
+        for c, (c0, c1) in enumerate(duplicate_tiles):
+            duplicate_tile = duplicate_matrix[c0:c1]
+            for r, (r0, r1) in enumerate(master_tiles):
+                rows, cols, values = _csr_to_triplets(self._build_matches(master_matrix[r0:r1], duplicate_tile))
+                _spill(spill_dir, f'tile_{r}_{c}', rows + r0, cols + c0, values)
+        # 2. merge the partial top-n of each master tile:
+        edge_list = _EdgeListWriter(spill_dir, master_matrix.dtype)
+        mirrors = [[] for _ in master_tiles]
+        for r, (r0, r1) in enumerate(master_tiles):
+            candidates = _TopNCandidates(ntop, 2 * (r1 - r0) * ntop)
+            for c in range(len(duplicate_tiles)):
+                candidates.add(*_unspill(spill_dir, f'tile_{r}_{c}'))
+            rows, cols, values = candidates.top_n()
+            if self._duplicates is not None:
+                edge_list.append(rows, cols, values)
+                continue
+            _spill(spill_dir, f'top_n_{r}', rows, cols, values)
+            # spill the transposed top-n to the tiles to which its rows belong:
+            destination = cols // tile_size
+            order = np.argsort(destination, kind='stable')
+            starts = np.searchsorted(destination[order], np.arange(len(master_tiles) + 1))
+            for d in np.flatnonzero(np.diff(starts)):
+                part = order[starts[d]:starts[d + 1]]
+                _spill(spill_dir, f'mirror_{d}_{r}', cols[part], rows[part], values[part])
+                mirrors[d].append(f'mirror_{d}_{r}')
+        if self._duplicates is None:
+            # the list of matches needs to be symmetric!!! (i.e., if A != B and A matches B; then B matches A)
+            for r in range(len(master_tiles)):
+                parts = [_unspill(spill_dir, name) for name in [f'top_n_{r}'] + mirrors[r]]
+                rows, cols, values = (np.concatenate(arrays) for arrays in zip(*parts))
+                # keep the largest similarity of each (master_side, dupe_side) pair, sorted by pair:
+                order = np.lexsort((-values, cols, rows))
+                rows, cols, values = rows[order], cols[order], values[order]
+                first = np.ones(len(rows), dtype=bool)
+                first[1:] = (rows[1:] != rows[:-1]) | (cols[1:] != cols[:-1])
+                edge_list.append(rows[first], cols[first], values[first])
+        master_side, dupe_side, similarity = edge_list.close()
+        return pd.DataFrame({'master_side': master_side,
+                             'dupe_side': dupe_side,
+                             'similarity': similarity},
+                            copy=False)
+
+    @staticmethod
+    def _symmetrize_matches(matches: csr_matrix) -> csr_matrix:
+        # [symmetrized matches] = element-wise maximum of [matches] and [transposed matches]
+        # (sorted by master_side and then by dupe_side, since sparse_dot_topn sorts each row by similarity instead):
+        symmetrized = matches.maximum(matches.transpose().tocsr())
+        symmetrized.sort_indices()
+        return symmetrized
 
     def _get_non_matches_list(self, suppress_warning=False) -> pd.DataFrame:
         """Returns a list of all the indices of non-matching pairs (with similarity set to 0)"""
+        blocks = list(self._iter_non_matches_blocks(DEFAULT_CHUNKSIZE, suppress_warning))
+        if not blocks: return pd.DataFrame()
+        return pd.concat(blocks, axis=0, ignore_index=True)
+
+    def _iter_non_matches_blocks(self, max_block_size: int, suppress_warning=False) -> Iterator[pd.DataFrame]:
+        """
+        Generates the indices of all non-matching pairs (with similarity set to 0), sorted by master_side and then by
+        dupe_side, in blocks of consecutive master strings.  Each block is the complement of the matches of its
+        master strings and holds at most max(max_block_size, d_sz) pairs, so all pairs are never held at once.
+        """
         m_sz, d_sz = len(self._master), len(self._master if self._duplicates is None else self._duplicates)
-        all_pairs = pd.MultiIndex.from_product([range(m_sz), range(d_sz)], names=['master_side', 'dupe_side'])
-        matched_pairs = pd.MultiIndex.from_frame(self._matches_list[['master_side', 'dupe_side']])
-        missing_pairs = all_pairs.difference(matched_pairs)
-        if missing_pairs.empty: return pd.DataFrame()
-        if (self._config.max_n_matches < d_sz) and not suppress_warning:
-            warnings.warn(f'WARNING: max_n_matches={self._config.max_n_matches} may be too small!\n'
-                          f'\t\t Some zero-similarity matches returned may be false!\n'
-                          f'\t\t To be absolutely certain all zero-similarity matches are true,\n'
-                          f'\t\t try setting max_n_matches={d_sz} (the length of the Series parameter duplicates).\n'
-                          f'\t\t To suppress this warning, set suppress_warning=True.')
-        missing_pairs = missing_pairs.to_frame(index=False)
-        missing_pairs['similarity'] = 0
-        return missing_pairs
+        by_master = np.argsort(self._matches_list.master_side.to_numpy(dtype=np.int64), kind='stable')
+        master_side = self._matches_list.master_side.to_numpy(dtype=np.int64)[by_master]
+        dupe_side = self._matches_list.dupe_side.to_numpy(dtype=np.int64)[by_master]
+        similarity_dtype = self._matches_list.similarity.dtype
+        warned = False
+        for start, stop in _tiles(m_sz, max(1, max_block_size // max(d_sz, 1))):
+            first, last = np.searchsorted(master_side, [start, stop])
+            is_matched = np.zeros((stop - start, d_sz), dtype=bool)
+            is_matched[master_side[first:last] - start, dupe_side[first:last]] = True
+            rows, cols = np.nonzero(~is_matched)
+            if len(rows) == 0: continue
+            if not warned and (self._config.max_n_matches < d_sz) and not suppress_warning:
+                warnings.warn(f'WARNING: max_n_matches={self._config.max_n_matches} may be too small!\n'
+                              f'\t\t Some zero-similarity matches returned may be false!\n'
+                              f'\t\t To be absolutely certain all zero-similarity matches are true,\n'
+                              f'\t\t try setting max_n_matches={d_sz} '
+                              f'(the length of the Series parameter duplicates).\n'
+                              f'\t\t To suppress this warning, set suppress_warning=True.')
+                warned = True
+            yield pd.DataFrame({'master_side': rows + start,
+                                'dupe_side': cols,
+                                'similarity': np.zeros(len(rows), dtype=similarity_dtype)},
+                               copy=False)
 
     @staticmethod
-    def _get_matches_list(matches) -> pd.DataFrame:
+    def _get_matches_list(matches: csr_matrix) -> pd.DataFrame:
         """Returns a list of all the indices of matches"""
-        non_zeros = matches.nonzero()
-
-        sparserows = non_zeros[0]
-        sparsecols = non_zeros[1]
-        nr_matches = sparsecols.size
-        master_side = np.empty([nr_matches], dtype=np.int64)
-        dupe_side = np.empty([nr_matches], dtype=np.int64)
-        similarity = np.zeros(nr_matches)
-
-        for index in range(0, nr_matches):
-            master_side[index] = sparserows[index]
-            dupe_side[index] = sparsecols[index]
-            similarity[index] = matches.data[index]
-
+        # The rows, columns and values of the csr matrix (in the order they are stored) need no per-element copying:
+        master_side = np.repeat(np.arange(matches.shape[0], dtype=np.int64), np.diff(matches.indptr))
+        dupe_side = matches.indices.astype(np.int64, copy=False)
+        similarity = matches.data
+        if not np.all(similarity):
+            # explicitly stored zeros are not matches:
+            nonzero = similarity != 0
+            master_side, dupe_side, similarity = master_side[nonzero], dupe_side[nonzero], similarity[nonzero]
         matches_list = pd.DataFrame({'master_side': master_side,
                                      'dupe_side': dupe_side,
-                                     'similarity': similarity})
+                                     'similarity': similarity},
+                                    copy=False)
         return matches_list
 
     def _get_nearest_matches(self,
@@ -521,31 +2714,34 @@ class StringGrouper(object):
             master = pd.concat([master, self._master_id.rename(master_id_label).reset_index(drop=True)], axis=1)
             dupes = pd.concat([dupes, self._duplicates_id.rename('duplicates_id').reset_index(drop=True)], axis=1)
 
-        dupes_max_sim = self._matches_list.groupby('dupe_side').agg({'similarity': 'max'}).reset_index()
-        dupes_max_sim = dupes_max_sim.merge(self._matches_list, on=['dupe_side', 'similarity'])
-
-        # In case there are multiple equal similarities, we pick the one that comes first
-        dupes_max_sim = dupes_max_sim.groupby(['dupe_side']).agg({'master_side': 'min'}).reset_index()
-
-        # First we add the duplicate strings
-        dupes_max_sim = dupes_max_sim.merge(dupes, left_on='dupe_side', right_index=True, how='outer')
-
-        # Now add the master strings
-        dupes_max_sim = dupes_max_sim.merge(master, left_on='master_side', right_index=True, how='left')
+        # For each duplicate, find its most similar master (the first one in case of ties; -1 if there is none)
+        # in the matches list sorted by duplicate:
+        dupe_side = self._matches_list.dupe_side.to_numpy(dtype=np.int64)
+        by_dupe = np.argsort(dupe_side, kind='stable')
+        indptr = np.append(0, np.cumsum(np.bincount(dupe_side, minlength=len(self._duplicates))))
+        best_master_side = _csr_row_argmax(indptr,
+                                           self._matches_list.master_side.to_numpy(dtype=np.int64)[by_dupe],
+                                           self._matches_list.similarity.to_numpy()[by_dupe])
+
+        # Gather the master strings (and index-columns and IDs), which are NaN where there is no match:
+        dupes_max_sim = master.reindex(best_master_side)
+        if isinstance(dupes_max_sim, pd.Series):
+            dupes_max_sim = dupes_max_sim.to_frame()
+        dupes_max_sim.index = dupes.index
+        dupe_strings = dupes if isinstance(dupes, pd.Series) else dupes['duplicates']
 
         # Update the master-series with the duplicates in cases were there is no match
-        rows_to_update = dupes_max_sim[master_label].isnull()
-        dupes_max_sim.loc[rows_to_update, master_label] = dupes_max_sim[rows_to_update].duplicates
+        rows_to_update = best_master_side < 0
+        dupes_max_sim.loc[rows_to_update, master_label] = dupe_strings[rows_to_update]
         if self._master_id is not None:
             # Also update the master_id-series with the duplicates_id in cases were there is no match
-            dupes_max_sim.loc[rows_to_update, master_id_label] = dupes_max_sim[rows_to_update].duplicates_id
+            dupes_max_sim.loc[rows_to_update, master_id_label] = dupes.loc[rows_to_update, 'duplicates_id']
             
-            # For some weird reason, pandas' merge function changes int-datatype columns to float when NaN values
-            # appear within them. So here we change them back to their original datatypes if possible:
+            # pandas changes int-datatype columns to float when NaN values appear within them. So here we change
+            # them back to their original datatypes if possible:
             if dupes_max_sim[master_id_label].dtype != self._master_id.dtype and \
                 self._duplicates_id.dtype == self._master_id.dtype:
-                dupes_max_sim.loc[:, master_id_label] = \
-                dupes_max_sim.loc[:, master_id_label].astype(self._master_id.dtype)
+                dupes_max_sim[master_id_label] = dupes_max_sim[master_id_label].astype(self._master_id.dtype)
             
         # Prepare the output:
         required_column_list = [master_label] if self._master_id is None else [master_id_label, master_label]
@@ -554,35 +2750,43 @@ class StringGrouper(object):
             if isinstance(master, pd.DataFrame) else []
         if replace_na:
             # Update the master index-columns with the duplicates index-column values in cases were there is no match
-            dupes_index_columns = [col for col in dupes.columns if str(col) != 'duplicates']
+            dupes_index_columns = [col for col in dupes.columns if str(col) not in ('duplicates', 'duplicates_id')]
             dupes_max_sim.loc[rows_to_update, index_column_list] = \
-            dupes_max_sim.loc[rows_to_update, dupes_index_columns].values
+            dupes.loc[rows_to_update, dupes_index_columns].values
             
             # Restore their original datatypes if possible:
             for m, d in zip(index_column_list, dupes_index_columns):
                 if dupes_max_sim[m].dtype != master[m].dtype and dupes[d].dtype == master[m].dtype:
-                    dupes_max_sim.loc[:, m] = dupes_max_sim.loc[:, m].astype(master[m].dtype)
+                    dupes_max_sim[m] = dupes_max_sim[m].astype(master[m].dtype)
                     
-        # Make sure to keep same order as duplicates
-        dupes_max_sim = dupes_max_sim.sort_values('dupe_side').set_index('dupe_side')
         output = dupes_max_sim[index_column_list + required_column_list]
         output.index = self._duplicates.index
         return output.squeeze()
 
+    def _get_disjoint_set(self) -> _DisjointSet:
+        """Returns the disjoint set of the groups of master, after building it or splitting its suspect groups"""
+        master_side = self._matches_list.master_side.to_numpy(dtype=np.int64)
+        dupe_side = self._matches_list.dupe_side.to_numpy(dtype=np.int64)
+        if self._disjoint_set is None:
+            self._disjoint_set = _DisjointSet(len(self._master))
+            self._disjoint_set.union_many(master_side, dupe_side)
+        elif self._split_suspects:
+            # regroup the members of the suspect groups using only the matches within those groups:
+            roots = self._disjoint_set.roots()
+            is_suspect = np.isin(roots, roots[list(self._split_suspects)])
+            is_suspect_match = is_suspect[master_side]
+            self._disjoint_set.regroup(np.flatnonzero(is_suspect),
+                                       master_side[is_suspect_match],
+                                       dupe_side[is_suspect_match])
+        self._split_suspects = set()
+        return self._disjoint_set
+
     def _deduplicate(self, ignore_index=False) -> Union[pd.DataFrame, pd.Series]:
         # discard self-matches: A matches A
         pairs = self._matches_list[self._matches_list['master_side'] != self._matches_list['dupe_side']]
-        # rebuild graph adjacency matrix from already found matches:
         n = len(self._master)
-        graph = csr_matrix(
-            (
-                np.full(len(pairs), 1),
-                (pairs.master_side.to_numpy(), pairs.dupe_side.to_numpy())
-            ),
-            shape=(n, n)
-        )
-        # apply scipy.csgraph's clustering algorithm (result is a 1D numpy array of length n):
-        _, groups = connected_components(csgraph=graph, directed=True)
+        # the groups are the sets of the disjoint set (a 1D numpy array of the root of each string's group):
+        groups = self._get_disjoint_set().roots()
         group_of_master_index = pd.Series(groups, name='raw_group_id')
 
         # merge groups with string indices to obtain two-column DataFrame:
@@ -595,11 +2799,10 @@ class StringGrouper(object):
         method = 'first'
         # 2. option-setting group_rep='centroid':
         if self._config.group_rep == GROUP_REP_CENTROID:
-            # reuse the adjacency matrix built above (change the 1's to corresponding cosine similarities):
-            graph.data = pairs['similarity'].to_numpy()
-            # sum along the rows to obtain numpy 1D matrix of similarity aggregates then ...
-            # ... convert to 1D numpy array (using asarray then squeeze) and then to Series:
-            group_of_master_index['weight'] = pd.Series(np.asarray(graph.sum(axis=1)).squeeze())
+            # sum the cosine similarities of the matches of each string to obtain the similarity aggregates:
+            group_of_master_index['weight'] = np.bincount(pairs.master_side.to_numpy(dtype=np.int64),
+                                                          weights=pairs.similarity.to_numpy(),
+                                                          minlength=n)
             method = 'idxmax'
 
         # Determine the group representatives AND merge with indices:
@@ -625,16 +2828,6 @@ class StringGrouper(object):
         output.index = self._master.index
         return output.squeeze()
 
-    def _get_indices_of(self, master_side: str, dupe_side: str) -> Tuple[pd.Series, pd.Series]:
-        master_strings = self._master
-        dupe_strings = self._master if self._duplicates is None else self._duplicates
-        # Check if input is valid:
-        self._validate_strings_exist(master_side, dupe_side, master_strings, dupe_strings)
-        # Get the indices of the two strings
-        master_indices = master_strings[master_strings == master_side].index.to_series().reset_index(drop=True)
-        dupe_indices = dupe_strings[dupe_strings == dupe_side].index.to_series().reset_index(drop=True)
-        return master_indices, dupe_indices
-    
     def _validate_group_rep_specs(self):
         group_rep_options = (GROUP_REP_FIRST, GROUP_REP_CENTROID)
         if self._config.group_rep not in group_rep_options:
@@ -642,6 +2835,49 @@ class StringGrouper(object):
                 f"Invalid option value for group_rep. The only permitted values are\n {group_rep_options}"
             )
 
+    def _validate_engine_specs(self):
+        engine_options = (ENGINE_SPARSE_DOT_TOPN, ENGINE_SYMMETRIC, ENGINE_PRUNED, ENGINE_LSH, ENGINE_BLOCKED)
+        if self._config.engine not in engine_options:
+            raise Exception(
+                f"Invalid option value for engine. The only permitted values are\n {engine_options}"
+            )
+
+    def _validate_dtype_specs(self):
+        dtype_options = (DTYPE_FLOAT32, DTYPE_FLOAT64)
+        if self._config.dtype not in dtype_options:
+            raise Exception(
+                f"Invalid option value for dtype. The only permitted values are\n {dtype_options}"
+            )
+
+    def _validate_lsh_specs(self):
+        if not (self._config.lsh_bands >= 1 and self._config.lsh_rows >= 1):
+            raise Exception("Invalid option values for lsh_bands and lsh_rows. They must be positive integers.")
+        if self._config.lsh_max_bucket_size is not None and not self._config.lsh_max_bucket_size >= 1:
+            raise Exception("Invalid option value for lsh_max_bucket_size. It must be None or a positive integer.")
+
+    def _validate_parallelism_specs(self):
+        parallelism_options = (PARALLELISM_THREADS, PARALLELISM_PROCESSES)
+        if self._config.parallelism not in parallelism_options:
+            raise Exception(
+                f"Invalid option value for parallelism. The only permitted values are\n {parallelism_options}"
+            )
+        if self._config.parallelism == PARALLELISM_PROCESSES and shared_memory is None:
+            raise Exception("parallelism='processes' requires Python 3.8 or later (multiprocessing.shared_memory).")
+
+    def _validate_tile_size_specs(self):
+        if self._config.tile_size is not None and not self._config.tile_size >= 1:
+            raise Exception("Invalid option value for tile_size. It must be None or a positive integer.")
+        if self._config.tile_size is not None and (self._block_by is not None or self._config.collapse_duplicates):
+            raise Exception("tile_size cannot be combined with block_by or collapse_duplicates=True (their matches "
+                            "are built in memory).")
+        if self._config.tile_size is not None and self._config.engine == ENGINE_SYMMETRIC:
+            raise Exception("tile_size cannot be combined with engine='symmetric' (which needs the whole matrix of "
+                            "master at once).")
+
+    def _validate_feature_hashing_specs(self):
+        if self._config.feature_hashing and not (1 <= self._config.hash_bits <= MAX_HASH_BITS):
+            raise Exception(f"Invalid option value for hash_bits. It must be an integer from 1 to {MAX_HASH_BITS}.")
+
     def _validate_replace_na_and_drop(self):
         if self._config.ignore_index and self._config.replace_na:
             raise Exception("replace_na can only be set to True when ignore_index=False.")
@@ -659,28 +2895,25 @@ class StringGrouper(object):
         return pd.concat([new_matches, columns_switched])
 
     @staticmethod
-    def _cross_join(dupe_indices, master_indices, similarities) -> pd.DataFrame:
-        x_join_index = pd.MultiIndex.from_product([master_indices, dupe_indices, similarities],
-                                                  names=['master_side', 'dupe_side', 'similarity'])
-        x_joined_df = pd.DataFrame(index=x_join_index).reset_index()
-        return x_joined_df
-
-    @staticmethod
-    def _validate_strings_exist(master_side, dupe_side, master_strings, dupe_strings):
-        if not master_strings.isin([master_side]).any():
-            raise ValueError(f'{master_side} not found in StringGrouper string series')
-        elif not dupe_strings.isin([dupe_side]).any():
-            raise ValueError(f'{dupe_side} not found in StringGrouper dupe string series')
+    def _as_series(strings):
+        """Wraps a pyarrow string array into a pandas.Series (without copying it); returns anything else as is"""
+        if pa is not None and isinstance(strings, (pa.Array, pa.ChunkedArray)) and \
+                (pa.types.is_string(strings.type) or pa.types.is_large_string(strings.type)):
+            if hasattr(pd.arrays, 'ArrowExtensionArray'):
+                return pd.Series(pd.arrays.ArrowExtensionArray(strings))
+            # (pandas < 1.5 has no Arrow-backed arrays of any Arrow type, so the strings are converted)
+            return strings.to_pandas()
+        return strings
 
     @staticmethod
     def _is_series_of_strings(series_to_test: pd.Series) -> bool:
         if not isinstance(series_to_test, pd.Series):
             return False
-        elif series_to_test.to_frame().applymap(
-                    lambda x: not isinstance(x, str)
-                ).squeeze().any():
-            return False
-        return True
+        if isinstance(series_to_test.dtype, pd.StringDtype) or _arrow_strings(series_to_test) is not None:
+            # the dtype guarantees strings, except for missing values:
+            return not series_to_test.isna().any()
+        # (infer_dtype checks every element, but without calling back into python)
+        return pd.api.types.infer_dtype(series_to_test, skipna=False) in ('string', 'empty')
 
     @staticmethod
     def _is_input_data_combination_valid(duplicates, master_id, duplicates_id) -> bool:
@@ -696,3 +2929,13 @@ class StringGrouper(object):
             raise Exception('Both master and master_id must be pandas.Series of the same length.')
         if duplicates is not None and duplicates_id is not None and len(duplicates) != len(duplicates_id):
             raise Exception('Both duplicates and duplicates_id must be pandas.Series of the same length.')
+
+    @staticmethod
+    def _validate_block_by_data(master, duplicates, block_by, duplicates_block_by):
+        if block_by is not None and len(master) != len(block_by):
+            raise Exception('Both master and block_by must be pandas.Series of the same length.')
+        if (duplicates is None and duplicates_block_by is not None) or \
+                (duplicates is not None and (block_by is None) != (duplicates_block_by is None)):
+            raise Exception('duplicates_block_by must be given if (and only if) both duplicates and block_by are.')
+        if duplicates_block_by is not None and len(duplicates) != len(duplicates_block_by):
+            raise Exception('Both duplicates and duplicates_block_by must be pandas.Series of the same length.')
@@ -1,14 +1,26 @@
 import unittest
+import re
+import json
+import sys
+import os
+import copy
+import tempfile
+import tracemalloc
 import pandas as pd
 import numpy as np
 from scipy.sparse.csr import csr_matrix
+from sklearn.feature_extraction.text import TfidfVectorizer
 from string_grouper.string_grouper import DEFAULT_MIN_SIMILARITY, \
-    DEFAULT_MAX_N_MATCHES, DEFAULT_REGEX, \
-    DEFAULT_NGRAM_SIZE, DEFAULT_N_PROCESSES, DEFAULT_IGNORE_CASE, \
-    StringGrouperConfig, StringGrouper, StringGrouperNotFitException, \
-    match_most_similar, group_similar_strings, match_strings,\
-    compute_pairwise_similarities
+    DEFAULT_MAX_N_MATCHES, DEFAULT_REGEX, DEFAULT_REGEX_CHARACTERS, \
+    DEFAULT_NGRAM_SIZE, DEFAULT_N_PROCESSES, DEFAULT_IGNORE_CASE, DEFAULT_HASH_BITS, \
+    StringGrouperConfig, StringGrouper, StringGrouperNotFitException, NGramTfidfVectorizer, _csr_row_argmax, \
+    _permute_columns, match_most_similar, group_similar_strings, match_strings, lsh_recall,\
+    compute_pairwise_similarities, shared_memory, SAVE_FORMAT_VERSION, _QueryIndex
 from unittest.mock import patch
+try:
+    import pyarrow as pa
+except ImportError:
+    pa = None
 import warnings
 
 
@@ -197,14 +209,14 @@ class StringGrouperTest(unittest.TestCase):
         mock_StringGrouper_instance.get_matches.assert_called_once()
         self.assertEqual(df, 'whatever')
 
-    @patch('string_grouper.string_grouper.StringGrouper._symmetrize_matches_list')
-    def test_match_list_symmetry_without_symmetrize_function(self, mock_symmetrize_matches_list):
-        """mocks StringGrouper._symmetrize_matches_list so that this test fails whenever _matches_list is 
+    @patch('string_grouper.string_grouper.StringGrouper._symmetrize_matches', side_effect=lambda matches: matches)
+    def test_match_list_symmetry_without_symmetrize_function(self, mock_symmetrize_matches):
+        """mocks StringGrouper._symmetrize_matches so that this test fails whenever _matches_list is 
         **partially** symmetric which often occurs when the kwarg max_n_matches is too small"""
         simple_example = SimpleExample()
         df = simple_example.customers_df2['Customer Name']
         sg = StringGrouper(df, max_n_matches=2).fit()
-        mock_symmetrize_matches_list.assert_called_once()
+        mock_symmetrize_matches.assert_called_once()
         # obtain the upper and lower triangular parts of the matrix of matches:
         upper = sg._matches_list[sg._matches_list['master_side'] < sg._matches_list['dupe_side']]
         lower = sg._matches_list[sg._matches_list['master_side'] > sg._matches_list['dupe_side']]
@@ -236,6 +248,522 @@ class StringGrouperTest(unittest.TestCase):
         # upper, upper_prime and their intersection should be identical.
         self.assertTrue(intersection.empty or len(upper) == len(upper_prime) == len(intersection))
 
+    def test_symmetrize_matches(self):
+        """The symmetrized matches should be the element-wise maximum of the matches and their transpose"""
+        matches = csr_matrix(np.array([[1., 0.9, 0.],
+                                       [0.8, 1., 0.],
+                                       [0.85, 0., 1.]]))
+        expected_matches = np.array([[1., 0.9, 0.85],
+                                     [0.9, 1., 0.],
+                                     [0.85, 0., 1.]])
+        np.testing.assert_array_equal(expected_matches, StringGrouper._symmetrize_matches(matches).toarray())
+
+    def test_symmetrize_matches_sorts_columns(self):
+        """The symmetrized matches should be sorted by column within each row even if the matches (like those of
+        sparse_dot_topn) are sorted by similarity"""
+        matches = csr_matrix((np.array([1., 0.9, 0.5, 1., 1.]),
+                              np.array([0, 2, 1, 1, 2]),
+                              np.array([0, 3, 4, 5])), shape=(3, 3))
+        symmetrized = StringGrouper._symmetrize_matches(matches)
+        np.testing.assert_array_equal(np.array([0, 1, 2, 0, 1, 0, 2]), symmetrized.indices)
+        np.testing.assert_array_equal(np.array([1., 0.5, 0.9, 0.5, 1., 0.9, 1.]), symmetrized.data)
+
+    @patch('string_grouper.string_grouper.SELF_JOIN_BLOCK_SIZE', 2)
+    def test_symmetric_engine_same_matches(self):
+        """The symmetric engine should find the same matches as sparse_dot_topn when matching a Series with itself,
+        even when max_n_matches truncates the matches (these strings have no ties in similarity)"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        for max_n_matches in [1, 2, 3, DEFAULT_MAX_N_MATCHES]:
+            for min_similarity in [0.1, 0.5]:
+                kwargs = dict(max_n_matches=max_n_matches, min_similarity=min_similarity)
+                expected = StringGrouper(test_series, number_of_processes=1, **kwargs).fit()._matches_list
+                for number_of_processes in [1, 3]:
+                    result = StringGrouper(test_series, engine='symmetric', number_of_processes=number_of_processes,
+                                           **kwargs).fit()._matches_list
+                    pd.testing.assert_frame_equal(expected, result)
+
+    def test_out_of_core_same_matches(self):
+        """Matching tile by tile (with spilling to disk) should find the same matches as matching all at once"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing'])
+        for duplicates in [None, test_duplicates]:
+            for tile_size in [1, 2, 4]:
+                kwargs = dict(max_n_matches=2, min_similarity=0.1, number_of_processes=1, ignore_index=True)
+                expected = StringGrouper(test_series, duplicates, **kwargs).fit()
+                result = StringGrouper(test_series, duplicates, tile_size=tile_size, **kwargs).fit()
+                pd.testing.assert_frame_equal(expected._matches_list, result._matches_list)
+                pd.testing.assert_series_equal(expected.get_groups(), result.get_groups())
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, tile_size=0)
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, block_by=test_series.str[0], tile_size=2)
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, collapse_duplicates=True, tile_size=2)
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, engine='symmetric', tile_size=2)
+
+    def test_out_of_core_uses_engine(self):
+        """Matching tile by tile should compute the similarities of each tile with the configured engine"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        for engine in ['pruned', 'blocked']:
+            kwargs = dict(max_n_matches=2, min_similarity=0.1, number_of_processes=1, ignore_index=True)
+            expected = StringGrouper(test_series, **kwargs).fit()
+            with patch.object(StringGrouper, '_build_topn_matches') as build_topn_matches:
+                result = StringGrouper(test_series, tile_size=4, engine=engine, **kwargs).fit()
+                build_topn_matches.assert_not_called()
+            pd.testing.assert_frame_equal(expected._matches_list, result._matches_list)
+
+    def test_update_merges_new_matches(self):
+        """Strings added by update should be matched with the fitted vocabulary and IDF, without refitting"""
+        master = pd.Series(['foooo', 'bar', 'baz'])
+        # 'oob' and 'arz' are not in the fitted vocabulary, so 'foooob' ~ 'foooo' and 'barz' ~ 'bar':
+        sg = StringGrouper(master, group_rep='first', max_idf_drift=10, number_of_processes=1).fit()
+        sg = sg.update(pd.Series(['foooob', 'barz']))
+        self.assertEqual(['foooo', 'bar', 'baz', 'foooo', 'bar'], list(sg.get_groups(ignore_index=True)))
+        self.assertEqual(list(range(5)), list(sg.get_groups().index))
+        sg = StringGrouper(master, pd.Series(['foooo']), max_idf_drift=10, number_of_processes=1).fit()
+        sg = sg.update(pd.Series(['foooob', 'dooz']))
+        self.assertEqual(['foooo', 'foooo', 'dooz'], list(sg.get_groups(ignore_index=True)))
+
+    def test_update_index(self):
+        """update should continue a default index, keep other indexes, and reject indexes that overlap"""
+        master = pd.Series(['foooo', 'bar', 'baz'], index=[10, 11, 12])
+        sg = StringGrouper(master, max_idf_drift=10, number_of_processes=1).fit()
+        sg = sg.update(pd.Series(['foooob'], index=[13]))
+        self.assertEqual([10, 11, 12, 13], list(sg.get_groups().index))
+        with self.assertRaises(Exception):
+            sg.update(pd.Series(['barz'], index=[11]))
+
+    def test_update_refits_on_idf_drift(self):
+        """update should refit from scratch once the IDF drifts by more than max_idf_drift"""
+        master = pd.Series(['foooo', 'foooob', 'bar', 'baz'])
+        new_strings = pd.Series(['barz', 'fooooba'])
+        sg = StringGrouper(master, max_idf_drift=0, number_of_processes=1).fit().update(new_strings)
+        expected = StringGrouper(pd.concat([master, new_strings], ignore_index=True), number_of_processes=1).fit()
+        pd.testing.assert_frame_equal(expected._matches_list, sg._matches_list)
+
+    def test_update_uses_engine(self):
+        """update should match the new strings with the configured engine, and reject collapse_duplicates=True"""
+        master = pd.Series(['foooo', 'foooob', 'bar', 'baz'])
+        new_strings = pd.Series(['barz', 'fooooba'])
+        for duplicates in [None, pd.Series(['foooob'])]:
+            kwargs = dict(min_similarity=0.1, max_idf_drift=10, number_of_processes=1)
+            expected = StringGrouper(master, duplicates, **kwargs).fit().update(new_strings)
+            sg = StringGrouper(master, duplicates, engine='blocked', **kwargs).fit()
+            with patch.object(StringGrouper, '_build_topn_matches') as build_topn_matches:
+                sg.update(new_strings)
+                build_topn_matches.assert_not_called()
+            pd.testing.assert_frame_equal(expected._matches_list, sg._matches_list)
+        sg = StringGrouper(master, collapse_duplicates=True).fit()
+        with self.assertRaises(Exception):
+            sg.update(new_strings)
+
+    def test_update_bad_ids(self):
+        """update should raise an exception if new_ids does not match the IDs given"""
+        sg = StringGrouper(pd.Series(['foooo', 'bar']), master_id=pd.Series([1, 2])).fit()
+        with self.assertRaises(Exception):
+            sg.update(pd.Series(['baz']))
+        with self.assertRaises(Exception):
+            sg.update(pd.Series(['baz']), pd.Series([3, 4]))
+
+    def test_save_and_load(self):
+        """A loaded StringGrouper should have the same matches as the saved one, and update them the same way"""
+        test_series = pd.Series(['foooo', 'foooob', 'bar', 'barz', 'baz'])
+        test_duplicates = pd.Series(['foooob', 'bazz'])
+        for duplicates, feature_hashing in [(None, False), (test_duplicates, False), (None, True)]:
+            for mmap in [True, False]:
+                kwargs = dict(feature_hashing=feature_hashing, max_idf_drift=10, number_of_processes=1)
+                sg = StringGrouper(test_series, duplicates, **kwargs).fit()
+                with tempfile.TemporaryDirectory() as path:
+                    sg.save(path)
+                    loaded = StringGrouper.load(path, mmap=mmap)
+                    pd.testing.assert_frame_equal(sg._matches_list, loaded._matches_list)
+                    # (memory-mapped strings are loaded as Arrow-backed strings)
+                    self.assertEqual(pd.StringDtype('pyarrow') if mmap else object, loaded._master.dtype)
+                    pd.testing.assert_series_equal(sg.get_groups(ignore_index=True),
+                                                   loaded.get_groups(ignore_index=True).astype(object))
+                    sg.update(pd.Series(['fooooba', 'bazz']))
+                    loaded.update(pd.Series(['fooooba', 'bazz']))
+                    pd.testing.assert_frame_equal(sg._matches_list, loaded._matches_list)
+
+    def test_save_and_load_strings(self):
+        """save should store the strings as UTF-8 bytes which load restores with their index and name"""
+        master = pd.Series(['fôöoo', '', 'bär 😀', 'baz'], index=[3, 1, 4, 1], name='names')
+        duplicates = pd.Series(['bär', 'fôö'], index=['a', 'b'])
+        sg = StringGrouper(master, duplicates, number_of_processes=1).fit()
+        with tempfile.TemporaryDirectory() as path:
+            sg.save(path)
+            for mmap in [True, False]:
+                loaded = StringGrouper.load(path, mmap=mmap)
+                pd.testing.assert_series_equal(master, loaded._master.astype(object))
+                pd.testing.assert_series_equal(duplicates, loaded._duplicates.astype(object))
+            with patch('string_grouper.string_grouper.pa', None):
+                loaded = StringGrouper.load(path)
+                pd.testing.assert_series_equal(master, loaded._master)
+            with patch('string_grouper.string_grouper.MAX_ARROW_CHUNK_BYTES', 4):
+                loaded = StringGrouper.load(path)
+                pd.testing.assert_series_equal(master, loaded._master.astype(object))
+
+    def test_load_other_format_version(self):
+        """load should refuse a StringGrouper saved in another format version"""
+        sg = StringGrouper(pd.Series(['foooo', 'foooob', 'bar']), number_of_processes=1).fit()
+        with tempfile.TemporaryDirectory() as path:
+            sg.save(path)
+            with open(os.path.join(path, 'string_grouper.json')) as file:
+                state = json.load(file)
+            state['format_version'] = SAVE_FORMAT_VERSION - 1
+            with open(os.path.join(path, 'string_grouper.json'), 'w') as file:
+                json.dump(state, file)
+            with self.assertRaises(Exception):
+                _ = StringGrouper.load(path)
+
+    def test_csr_row_argmax(self):
+        """Should return the column of each row's largest value, the smallest column on ties, and -1 if empty"""
+        matrix = csr_matrix(np.array([[0.0, 0.5, 0.9],
+                                      [0.0, 0.0, 0.0],
+                                      [0.7, 0.0, 0.7],
+                                      [0.0, 0.2, 0.0]]))
+        # the columns of a row need not be sorted:
+        indices, data = matrix.indices.copy(), matrix.data.copy()
+        indices[[2, 3]], data[[2, 3]] = indices[[3, 2]], data[[3, 2]]
+        np.testing.assert_array_equal(np.array([2, -1, 0, 1]), _csr_row_argmax(matrix.indptr, indices, data))
+
+    @patch('string_grouper.string_grouper.NEAREST_BLOCK_SIZE', 2)
+    def test_nearest_only_same_groups(self):
+        """The top-1 kernel used by match_most_similar should pick the same master strings as the top-n kernel"""
+        # the duplicate master strings at index 1 and 3 fall into different blocks:
+        master = pd.Series(['bar', 'foooo', 'baz', 'foooo', 'fooooba', 'barz'])
+        duplicates = pd.Series(['foooob', 'new', 'baz', 'foooo', 'barz', 'fooobar'])
+        for kwargs in [dict(), dict(min_similarity=0.1)]:
+            expected = StringGrouper(master, duplicates, number_of_processes=1, **kwargs).fit().get_groups()
+            for number_of_processes in [1, 3]:
+                result = StringGrouper(master, duplicates, number_of_processes=number_of_processes,
+                                       **kwargs).fit(nearest_only=True)
+                pd.testing.assert_frame_equal(expected, result.get_groups())
+            pd.testing.assert_frame_equal(expected, match_most_similar(master, duplicates, **kwargs))
+
+    def test_groups_maintained_incrementally(self):
+        """Groups kept up to date through add_match and remove_match should equal groups rebuilt from scratch, whether
+        the groups are united one pair at a time or all at once"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'bar', 'barz', 'baz'])
+        for batch_union_ratio in [1, len(test_series) + 1]:
+            with patch('string_grouper.string_grouper.BATCH_UNION_RATIO', batch_union_ratio):
+                sg = StringGrouper(test_series, min_similarity=0.5, number_of_processes=1).fit()
+                _ = sg.get_groups()
+                edits = [lambda: sg.add_match('foooo', 'bar'),
+                         lambda: sg.remove_match('foooo', 'bar'),
+                         lambda: sg.remove_match('foooob', 'fooooba'),
+                         lambda: sg.add_match('baz', 'fooooba')]
+                for edit in edits:
+                    edit()
+                    rebuilt = copy.copy(sg)
+                    rebuilt._disjoint_set = None
+                    pd.testing.assert_frame_equal(rebuilt.get_groups(), sg.get_groups())
+
+    def test_float32_same_groups(self):
+        """dtype='float32' should hold end to end and give the same groups as float64 on the tutorial data"""
+        accounts = pd.read_csv(os.path.join(os.path.dirname(__file__), '..', '..', 'tutorials', 'accounts.csv'))
+        customers = SimpleExample().customers_df['Customer Name']
+        for strings in [accounts['name'], customers]:
+            for group_rep in ['centroid', 'first']:
+                expected = group_similar_strings(strings, group_rep=group_rep, number_of_processes=1)
+                result = group_similar_strings(strings, group_rep=group_rep, dtype='float32', number_of_processes=1)
+                pd.testing.assert_frame_equal(expected, result)
+            master, duplicates = strings.iloc[::2], strings.iloc[1::2]
+            expected = match_most_similar(master, duplicates, min_similarity=0.5, number_of_processes=1)
+            result = match_most_similar(master, duplicates, min_similarity=0.5, dtype='float32', number_of_processes=1)
+            pd.testing.assert_frame_equal(expected, result)
+            for feature_hashing in [False, True]:
+                sg = StringGrouper(strings, dtype='float32', feature_hashing=feature_hashing).fit()
+                self.assertEqual(np.float32, sg.get_matches().similarity.dtype)
+        with self.assertRaises(Exception):
+            _ = StringGrouper(customers, dtype='float16')
+
+    def test_collect_stats(self):
+        """Should record each stage of fit, get_matches and get_groups if (and only if) collect_stats=True"""
+        test_series = pd.Series(['foooo', 'foooob', 'bar'])
+        sg = StringGrouper(test_series).fit()
+        _ = sg.get_groups()
+        self.assertEqual([], sg.stats)
+        sg = StringGrouper(test_series, collect_stats=True).fit()
+        _ = sg.get_matches()
+        _ = sg.get_groups()
+        self.assertEqual(
+            [
+                ('fit', 'fit_vectorizer'), ('fit', 'transform'), ('fit', 'build_matches'), ('fit', 'symmetrize'),
+                ('fit', 'get_matches_list'), ('fit', 'fit'),
+                ('get_matches', 'get_matches_output'), ('get_matches', 'get_matches'),
+                ('get_groups', 'deduplicate'), ('get_groups', 'get_groups')
+            ],
+            [(record['call'], record['stage']) for record in sg.stats]
+        )
+        self.assertTrue(all(record['wall_s'] >= 0 and record['cpu_s'] >= 0 for record in sg.stats))
+        transform = sg.stats[1]
+        self.assertEqual(3, transform['shapes'][0][0])
+        self.assertEqual(sg.stats[0]['n_features'], transform['shapes'][0][1])
+        if hasattr(tracemalloc, 'reset_peak'):
+            # while tracemalloc traces, the peak of each call should be that of its largest stage (or more):
+            tracemalloc.start()
+            try:
+                sg = StringGrouper(test_series, collect_stats=True).fit()
+            finally:
+                tracemalloc.stop()
+            peaks = {record['stage']: record['peak_traced_mb'] for record in sg.stats}
+            self.assertTrue(peaks['build_matches'] > 0)
+            self.assertEqual(peaks['fit'], max(peaks.values()))
+
+    @patch('string_grouper.string_grouper.PRUNED_BLOCK_SIZE', 2)
+    def test_pruned_engine_same_matches(self):
+        """The pruned engine should find exactly the same matches as sparse_dot_topn"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing'])
+        for duplicates in [None, test_duplicates]:
+            for min_similarity in [0.05, 0.3, 0.6, 0.8]:
+                kwargs = dict(min_similarity=min_similarity, number_of_processes=1)
+                expected = StringGrouper(test_series, duplicates, **kwargs).fit()
+                result = StringGrouper(test_series, duplicates, engine='pruned', **kwargs).fit()
+                # (the order of tied similarities within a row may differ)
+                expected, result = (sg._matches_list.sort_values(['master_side', 'dupe_side'], ignore_index=True)
+                                    for sg in (expected, result))
+                pd.testing.assert_frame_equal(expected, result)
+
+    def test_permute_columns_leaves_input_unchanged(self):
+        """_permute_columns should return a permuted copy and leave the input matrix as it was"""
+        matrix = csr_matrix(np.array([[0.1, 0.2, 0.3],
+                                      [0.4, 0.0, 0.5]]))
+        original = matrix.copy()
+        permuted = _permute_columns(matrix, np.array([2, 1, 0]))
+        np.testing.assert_array_equal(original.toarray()[:, ::-1], permuted.toarray())
+        for name in ('data', 'indices', 'indptr'):
+            np.testing.assert_array_equal(getattr(original, name), getattr(matrix, name))
+
+    def test_lsh_engine_finds_exact_matches(self):
+        """The lsh engine should only find exact matches, and with enough bands all of them"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz', ''])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing', ''])
+        for duplicates in [None, test_duplicates]:
+            kwargs = dict(min_similarity=0.5, number_of_processes=1, lsh_bands=50, lsh_rows=1)
+            exact = StringGrouper(test_series, duplicates, **kwargs).fit()._matches_list
+            approximate = StringGrouper(test_series, duplicates, engine='lsh', **kwargs).fit()._matches_list
+            found = approximate.merge(exact, on=['master_side', 'dupe_side'], how='left', suffixes=('', '_exact'))
+            np.testing.assert_allclose(found.similarity, found.similarity_exact)
+            self.assertEqual(1.0, lsh_recall(test_series, duplicates, **kwargs))
+
+    def test_lsh_bad_option_values(self):
+        """Should raise an exception when the lsh options are not positive integers"""
+        for kwargs in [dict(lsh_bands=0), dict(lsh_rows=0), dict(lsh_max_bucket_size=0)]:
+            with self.assertRaises(Exception):
+                _ = StringGrouper(pd.Series(['foooo', 'bar', 'baz']), engine='lsh', **kwargs)
+
+    def test_block_by_matches_within_blocks(self):
+        """Should find the matches of pairs of strings with the same blocking key only"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_keys = pd.Series(['a', 'a', 'b', 'b', 'a', 'a', 'b', None, None])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'fooooba'])
+        test_duplicates_keys = pd.Series(['a', None, 'b', 'b', 'b'])
+        for duplicates, duplicates_keys in [(None, None), (test_duplicates, test_duplicates_keys)]:
+            kwargs = dict(min_similarity=0.1, number_of_processes=2)
+            all_matches = StringGrouper(test_series, duplicates, **kwargs).fit()._matches_list
+            dupe_keys = test_keys if duplicates is None else duplicates_keys
+            same_key = test_keys.fillna('').to_numpy()[all_matches.master_side] == \
+                dupe_keys.fillna('').to_numpy()[all_matches.dupe_side]
+            expected = all_matches[same_key].sort_values(['master_side', 'dupe_side'], ignore_index=True)
+            result = StringGrouper(test_series, duplicates, block_by=test_keys, duplicates_block_by=duplicates_keys,
+                                   **kwargs).fit()._matches_list
+            result = result.sort_values(['master_side', 'dupe_side'], ignore_index=True)
+            pd.testing.assert_frame_equal(expected, result)
+
+    def test_block_by_bad_data(self):
+        """Should raise an exception when the blocking keys do not fit the strings"""
+        test_series = pd.Series(['foooo', 'bar', 'baz'])
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, block_by=pd.Series(['a', 'b']))
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, test_series, block_by=pd.Series(['a', 'b', 'c']))
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, duplicates_block_by=pd.Series(['a', 'b', 'c']))
+        keys = pd.Series(['a', 'b', 'c'])
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series, test_series, block_by=keys, duplicates_block_by=keys).fit(nearest_only=True)
+
+    @unittest.skipIf(shared_memory is None, 'multiprocessing.shared_memory requires Python 3.8 or later')
+    def test_processes_same_matches(self):
+        """Worker processes sharing the TF-IDF matrices should find the same matches as a single thread"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing'])
+        for duplicates in [None, test_duplicates]:
+            expected = StringGrouper(test_series, duplicates, min_similarity=0.1, number_of_processes=1).fit()
+            result = StringGrouper(test_series, duplicates, min_similarity=0.1, number_of_processes=2,
+                                   parallelism='processes').fit()
+            pd.testing.assert_frame_equal(expected._matches_list, result._matches_list)
+
+    def test_parallelism_bad_option_value(self):
+        """Should raise an exception when parallelism is not one of the permitted values"""
+        with self.assertRaises(Exception):
+            _ = StringGrouper(pd.Series(['foooo', 'bar', 'baz']), parallelism='nonsense')
+
+    @patch('string_grouper.string_grouper.MIN_PARTITION_SIZE', 2)
+    def test_parallel_tokenization_same_matrices(self):
+        """Tokenizing partitions of the strings concurrently should give the same TF-IDF matrices"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing'])
+        for feature_hashing in [False, True]:
+            serial = StringGrouper(test_series, test_duplicates, feature_hashing=feature_hashing,
+                                   number_of_processes=1)
+            parallel = StringGrouper(test_series, test_duplicates, feature_hashing=feature_hashing,
+                                     number_of_processes=3)
+            for expected, result in zip(serial._get_tf_idf_matrices(), parallel._get_tf_idf_matrices()):
+                self.assertEqual(expected.shape, result.shape)
+                self.assertEqual(0, (expected != result).nnz)
+
+    @patch('string_grouper.string_grouper.ACCUMULATOR_ROWS', 2)
+    @patch('string_grouper.string_grouper.ACCUMULATOR_COLUMNS', 3)
+    def test_blocked_engine_same_matches(self):
+        """The blocked engine should find the same matches as sparse_dot_topn"""
+        test_series = pd.Series(['foooo', 'foooob', 'fooooba', 'foobar', 'bar', 'barz', 'baz', 'bazooka', 'fobaz'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'nothing'])
+        for duplicates in [None, test_duplicates]:
+            for number_of_processes in [1, 2]:
+                kwargs = dict(min_similarity=0.1, number_of_processes=number_of_processes)
+                expected = StringGrouper(test_series, duplicates, **kwargs).fit()
+                result = StringGrouper(test_series, duplicates, engine='blocked', **kwargs).fit()
+                expected, result = (sg._matches_list.sort_values(['master_side', 'dupe_side'], ignore_index=True)
+                                    for sg in (expected, result))
+                pd.testing.assert_frame_equal(expected, result)
+
+    def test_collapse_duplicates_same_matches(self):
+        """Matching only one copy of each repeated string should give the same matches and groups"""
+        test_series = pd.Series(['foooo', 'FOOOO', 'foooob', 'foo-oob', 'fooooba', 'foobar', 'bar', 'bar', 'bar',
+                                 'barz', 'baz', 'bazooka', 'fobaz', 'Bar'])
+        test_duplicates = pd.Series(['foooob', 'bazooka', 'barz', 'foo bar', 'foooob', 'Foo.oob', 'nothing'])
+        for duplicates in [None, test_duplicates]:
+            kwargs = dict(min_similarity=0.1, max_n_matches=len(test_series), number_of_processes=1)
+            expected = StringGrouper(test_series, duplicates, **kwargs).fit()
+            result = StringGrouper(test_series, duplicates, collapse_duplicates=True, **kwargs).fit()
+            pd.testing.assert_frame_equal(
+                expected._matches_list.sort_values(['master_side', 'dupe_side'], ignore_index=True),
+                result._matches_list.sort_values(['master_side', 'dupe_side'], ignore_index=True)
+            )
+            if duplicates is None:
+                pd.testing.assert_frame_equal(expected.get_groups(), result.get_groups())
+
+    def test_collapse_duplicates_truncated_matches(self):
+        """With fewer max_n_matches than copies, collapsing should keep matches of the same similarities, and the
+        nearest matches of match_most_similar should be the same"""
+        master = pd.Series(['foooo', 'foooob', 'bar', 'barz', 'baz'] * 3)
+        duplicates = pd.Series(['foooob', 'FOOOOB', 'barz', 'bazz', 'foooob', 'nothing'] * 4)
+        kwargs = dict(min_similarity=0.1, max_n_matches=3, number_of_processes=1)
+        expected, result = (StringGrouper(master, duplicates, collapse_duplicates=collapse, **kwargs).fit()
+                            ._matches_list.groupby('master_side').similarity.apply(lambda s: sorted(s.round(12)))
+                            for collapse in (False, True))
+        pd.testing.assert_series_equal(expected, result)
+        for ignore_index in [True, False]:
+            kwargs = dict(min_similarity=0.1, number_of_processes=1, ignore_index=ignore_index)
+            pd.testing.assert_frame_equal(
+                pd.DataFrame(match_most_similar(master, duplicates, **kwargs)),
+                pd.DataFrame(match_most_similar(master, duplicates, collapse_duplicates=True, **kwargs))
+            )
+        sg = StringGrouper(master, duplicates, collapse_duplicates=True, number_of_processes=1)
+        self.assertTrue(sg.fit(nearest_only=True)._nearest_only)
+
+    @unittest.skipIf(pa is None, 'pyarrow is not installed')
+    def test_arrow_strings_same_matches(self):
+        """Arrow-backed strings should be validated and matched like object strings"""
+        strings = ['Café Zürich', 'cafe zurich', 'CAFÉ ZÜRICH AG', 'foo-bar', 'foo bar', 'Ünïcödé ✓ 😀', 'ünïcödé ✓',
+                   # (lowercased differently by Arrow's utf8_lower and python's str.lower:)
+                   'İSTANBUL ΟΔΟΣ', 'istanbul οδοσ', 'İstanbul Οδος']
+        test_series = pd.Series(strings)
+        for arrow_strings in [test_series.astype('string[pyarrow]'), pa.array(strings), pa.chunked_array([strings])]:
+            # (lookbehinds are not supported by Arrow's RE2, and its \w and \s only match ASCII characters)
+            for regex in [DEFAULT_REGEX, r'[ü]', r'(?<=f)o', r'[^\w\s]']:
+                for collapse_duplicates in [False, True]:
+                    kwargs = dict(regex=regex, min_similarity=0.1, number_of_processes=1,
+                                  collapse_duplicates=collapse_duplicates)
+                    expected = StringGrouper(test_series, **kwargs).fit()._matches_list
+                    result = StringGrouper(arrow_strings, **kwargs).fit()._matches_list
+                    pd.testing.assert_frame_equal(expected, result)
+        with self.assertRaises(TypeError):
+            _ = StringGrouper(pd.Series(strings + [None], dtype='string[pyarrow]'))
+
+    def test_add_and_remove_matches_in_batches(self):
+        """add_matches and remove_matches should apply many edits at once as add_match and remove_match would"""
+        test_series_1 = pd.Series(['foooo', 'no match', 'baz', 'foooo', 'bar', 'foooob'])
+        test_series_2 = pd.Series(['foooo', 'bar', 'baz', 'foooob', 'bar'])
+
+        def assert_same_matches(sg1, sg2):
+            # (the matches of a batch may be listed in another order)
+            matches_1, matches_2 = sg1.get_matches(), sg2.get_matches()
+            pd.testing.assert_frame_equal(matches_1.sort_values(list(matches_1.columns)).reset_index(drop=True),
+                                          matches_2.sort_values(list(matches_2.columns)).reset_index(drop=True))
+
+        for duplicates in (None, test_series_2):
+            edits = [('no match', 'baz'), ('foooo', 'bar')]
+            one_by_one = StringGrouper(test_series_1, duplicates).fit()
+            for master_side, dupe_side in edits:
+                one_by_one.add_match(master_side, dupe_side)
+            in_batch = StringGrouper(test_series_1, duplicates).fit().add_matches(edits)
+            assert_same_matches(one_by_one, in_batch)
+            in_batch = StringGrouper(test_series_1, duplicates).fit()
+            in_batch.add_matches(pd.DataFrame(edits, columns=['left', 'right']))
+            assert_same_matches(one_by_one, in_batch)
+
+            for master_side, dupe_side in edits + [('foooo', 'foooob')]:
+                one_by_one.remove_match(master_side, dupe_side)
+            in_batch.remove_matches(edits + [('foooo', 'foooob')])
+            assert_same_matches(one_by_one, in_batch)
+            with self.assertRaises(ValueError):
+                in_batch.remove_matches([('baz', 'baz'), ('doesnt exist', 'baz')])
+            self.assertIs(in_batch, in_batch.add_matches([]))
+        sg = StringGrouper(test_series_1).fit().add_matches([('no match', 'baz'), ('baz', 'bar')])
+        groups = sg.get_groups(ignore_index=True)
+        self.assertEqual(1, groups[test_series_1.isin(['no match', 'baz', 'bar'])].nunique())
+
+    def test_query(self):
+        """query should return the same most similar master strings as get_matches"""
+        master = pd.Series(['foo bar baz', 'foo bar', 'bar baz foo', 'barbaz', 'foobar inc', 'baz', 'foo bar bazz'],
+                           index=list('abcdefg'))
+        queries = pd.Series(['foo bar baz', 'foo baz', 'barbaz inc', 'qux'])
+        sg = StringGrouper(master, queries, min_similarity=0.1, max_n_matches=len(master)).fit()
+        matches = sg.get_matches()
+        for query in queries:
+            expected = matches[matches.right_side == query].sort_values('similarity', ascending=False)
+            for k, min_similarity in ((2, None), (len(master), 0.5)):
+                found = sg.query(query, k=k, min_similarity=min_similarity)
+                threshold = 0.1 if min_similarity is None else min_similarity
+                expected_k = expected[expected.similarity > threshold].head(k)
+                np.testing.assert_allclose(found.similarity.to_numpy(), expected_k.similarity.to_numpy())
+                if k == len(master):
+                    self.assertEqual(set(found.index), set(expected_k.left_index))
+        self.assertEqual(['master', 'similarity'], list(sg.query('foo').columns))
+        self.assertTrue(sg.query('qux').empty)
+        with self.assertRaises(ValueError):
+            sg.query('foo', k=0)
+
+    def test_query_index_search(self):
+        """query should find the k most similar master strings of an exhaustive search, also once the master strings
+        left in the running are looked up in their own rows instead of the postings of the non-essential n-grams"""
+        rng = np.random.default_rng(0)
+        words = ['alpha', 'beta', 'gamma', 'delta', 'epsilon', 'zeta', 'eta', 'theta', 'iota', 'kappa', 'inc']
+        master = pd.Series([' '.join(rng.choice(words, size=rng.integers(1, 5))) for _ in range(400)])
+        queries = ['alpha beta inc', 'gamma', 'kappa iota zeta', 'delta delta eta', 'lambda']
+        sg = StringGrouper(master, pd.Series(queries), min_similarity=0.1).fit()
+        with patch.object(_QueryIndex, '_weights_of', autospec=True, side_effect=_QueryIndex._weights_of) as weights_of:
+            for query in queries:
+                query_vector = sg._vectorizer.transform(pd.Series([query]))
+                similarities = (sg._master_matrix @ query_vector.T).toarray().ravel()
+                for k, min_similarity in ((1, 0.1), (5, 0.3), (20, 0.0), (400, 0.6)):
+                    found = sg.query(query, k=k, min_similarity=min_similarity)
+                    expected = np.lexsort((np.arange(len(master)), -similarities))[:k]
+                    expected = expected[similarities[expected] > min_similarity]
+                    np.testing.assert_allclose(found.similarity.to_numpy(), similarities[expected], rtol=1e-6)
+                    np.testing.assert_allclose(similarities[found.index], found.similarity.to_numpy(), rtol=1e-6)
+        self.assertTrue(weights_of.called)
+
+    def test_engine_bad_option_value(self):
+        """Should raise an exception when engine is not one of the permitted values"""
+        with self.assertRaises(Exception):
+            _ = StringGrouper(pd.Series(['foooo', 'bar', 'baz']), engine='nonsense')
+
     def test_match_list_diagonal(self):
         """test fails whenever _matches_list's number of self-joins is not equal to the number of strings"""
         # This bug is difficult to reproduce -- I mostly encounter it while working with very large datasets;
@@ -266,6 +794,19 @@ class StringGrouperTest(unittest.TestCase):
         with self.assertRaises(Exception):
             _ = match_strings(s_master, s_dup, max_n_matches=1, min_similarity=0)
 
+    def test_iter_matches_same_as_get_matches(self):
+        """The chunks of iter_matches (zero-similarity matches included) should add up to the output of get_matches"""
+        simple_example = SimpleExample()
+        s_master = simple_example.customers_df['Customer Name']
+        for s_dup in [None, simple_example.two_strings]:
+            sg = StringGrouper(s_master, s_dup, max_n_matches=len(s_master), min_similarity=0).fit()
+            for chunksize in [1, 2, 5, 100]:
+                chunks = list(sg.iter_matches(chunksize=chunksize))
+                self.assertTrue(all(len(chunk) <= chunksize for chunk in chunks))
+                pd.testing.assert_frame_equal(sg.get_matches(), pd.concat(chunks))
+        with self.assertRaises(Exception):
+            _ = sg.iter_matches(chunksize=0)
+
     def test_get_non_matches_empty_case(self):
         """This test ensures that _get_non_matches() returns an empty DataFrame when all pairs of strings match"""
         simple_example = SimpleExample()
@@ -298,6 +839,67 @@ class StringGrouperTest(unittest.TestCase):
         expected_result = ['mcd', 'cdo', 'don', 'ona', 'nal', 'ald', 'lds']
         self.assertListEqual(expected_result, sg.n_grams('McDonalds'))
 
+    def test_bulk_n_grams_same_as_n_grams(self):
+        """NGramTfidfVectorizer should produce exactly the same vocabulary and matrices as a TfidfVectorizer that
+        calls StringGrouper.n_grams once per string"""
+        simple_example = SimpleExample()
+        master = simple_example.customers_df2['Customer Name']
+        duplicates = pd.Series(['hyper  Start-Up, Inc.', 'MEGA\tcorp', 'x', '', 'Mega Enterprises Corporation'])
+        for kwargs in [{}, {'ignore_case': False}, {'ngram_size': 1}, {'ngram_size': 2}, {'ngram_size': 4},
+                       {'regex': r'[^\w\s]'}, {'regex': r'\s', 'ngram_size': 2, 'ignore_case': False}]:
+            sg = StringGrouper(master, duplicates, **kwargs)
+            self.assertIsInstance(sg._vectorizer, NGramTfidfVectorizer)
+            master_matrix, duplicate_matrix = sg._get_tf_idf_matrices()
+            reference = TfidfVectorizer(min_df=1, analyzer=sg.n_grams).fit(pd.concat([master, duplicates]))
+            self.assertDictEqual(reference.vocabulary_, sg._vectorizer.vocabulary_)
+            np.testing.assert_array_equal(reference.idf_, sg._vectorizer.idf_)
+            np.testing.assert_array_equal(reference.transform(master).toarray(), master_matrix.toarray())
+            np.testing.assert_array_equal(reference.transform(duplicates).toarray(), duplicate_matrix.toarray())
+
+    def test_default_regex_characters(self):
+        """DEFAULT_REGEX_CHARACTERS should hold exactly the characters that DEFAULT_REGEX matches"""
+        all_characters = ''.join(map(chr, range(sys.maxunicode + 1)))
+        self.assertEqual(sorted(re.findall(DEFAULT_REGEX, all_characters)), sorted(DEFAULT_REGEX_CHARACTERS))
+
+    def test_feature_hashing_same_similarities(self):
+        """With feature_hashing=True (and no hash collisions, as here) the cosine similarities should be the same
+        as those obtained with a vocabulary"""
+        simple_example = SimpleExample()
+        master = simple_example.customers_df2['Customer Name']
+        duplicates = simple_example.customers_df['Customer Name']
+        for dupes in [None, duplicates]:
+            master_matrix, duplicate_matrix = StringGrouper(master, dupes)._get_tf_idf_matrices()
+            sg = StringGrouper(master, dupes, feature_hashing=True)
+            hashed_master_matrix, hashed_duplicate_matrix = sg._get_tf_idf_matrices()
+            self.assertEqual(2**DEFAULT_HASH_BITS, hashed_master_matrix.shape[1])
+            np.testing.assert_allclose(
+                (master_matrix @ duplicate_matrix.T).toarray(),
+                (hashed_master_matrix @ hashed_duplicate_matrix.T).toarray()
+            )
+            # fit followed by transform should give the same matrix as fit_transform:
+            refitted_master_matrix = \
+                sg._vectorizer.fit(*([master] if dupes is None else [master, dupes])).transform(master)
+            self.assertEqual(0, (hashed_master_matrix != refitted_master_matrix).nnz)
+
+    def test_feature_hashing_large_n_grams(self):
+        """With feature_hashing=True n-grams larger than 3 characters that differ only in their leading characters
+        should not be hashed into the same column"""
+        for ngram_size in [4, 5]:
+            strings = pd.Series(['abcde'[:ngram_size], 'cbcde'[:ngram_size], 'zbcde'[:ngram_size],
+                                 'zzcde'[:ngram_size]])
+            master_matrix, _ = StringGrouper(strings, ngram_size=ngram_size, feature_hashing=True,
+                                             hash_bits=20)._get_tf_idf_matrices()
+            self.assertEqual(len(strings), len(set(master_matrix.indices)))
+            np.testing.assert_allclose(np.eye(len(strings)), (master_matrix @ master_matrix.T).toarray())
+
+    def test_feature_hashing_bad_hash_bits(self):
+        """Should raise an exception when hash_bits is out of range"""
+        test_series_1 = pd.Series(['foooo', 'bar', 'baz'])
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series_1, feature_hashing=True, hash_bits=0)
+        with self.assertRaises(Exception):
+            _ = StringGrouper(test_series_1, feature_hashing=True, hash_bits=64)
+
     def test_build_matrix(self):
         """Should create a csr matrix only master"""
         test_series = pd.Series(['foo', 'bar', 'baz'])
@@ -349,6 +951,15 @@ class StringGrouperTest(unittest.TestCase):
         expected_df = pd.DataFrame({'master_side': master, 'dupe_side': dupe_side, 'similarity': similarity})
         pd.testing.assert_frame_equal(expected_df, sg._matches_list)
 
+    def test_get_matches_list_from_csr(self):
+        """Should list the stored nonzero elements of a csr matrix in storage order, skipping explicit zeros"""
+        matches = csr_matrix(
+            (np.array([0.9, 0., 0.7, 1.]), np.array([2, 0, 1, 0]), np.array([0, 2, 2, 4])),
+            shape=(3, 3)
+        )
+        expected_df = pd.DataFrame({'master_side': [0, 2, 2], 'dupe_side': [2, 1, 0], 'similarity': [0.9, 0.7, 1.]})
+        pd.testing.assert_frame_equal(expected_df, StringGrouper._get_matches_list(matches))
+
     def test_case_insensitive_build_matches_list(self):
         """Should create the cosine similarity matrix of two case insensitive series"""
         test_series_1 = pd.Series(['foo', 'BAR', 'baz'])